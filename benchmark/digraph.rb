@@ -0,0 +1,59 @@
+# frozen_string_literal: true
+
+# Compare Lrama::Digraph with Lrama::IndexedDigraph on the read sets and
+# follow sets computation of a grammar.
+#
+#   $ ruby benchmark/digraph.rb [GRAMMAR_FILE] [ITERATIONS]
+
+require "benchmark"
+require_relative "../lib/lrama"
+
+path = ARGV[0] || File.expand_path("../sample/parse.y", __dir__)
+iterations = (ARGV[1] || 1000).to_i
+
+grammar = Lrama::Parser.new(File.read(path), path).parse
+grammar.prepare
+grammar.validate!
+states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new))
+states.compute
+
+gotos = states.instance_variable_get(:@nterm_transitions)
+size = gotos.count
+reads_relation = states.instance_variable_get(:@reads_relation)
+includes_relation = states.instance_variable_get(:@includes_relation)
+direct_read_sets = states.instance_variable_get(:@direct_read_sets)
+
+# Digraph takes nodes as objects, relations and attributes as hashes keyed by gotos
+to_hash = ->(ary) { ary.each_with_index.to_h {|v, i| [gotos[i], v] } }
+to_relation = ->(ary) { ary.each_with_index.filter_map {|ids, i| [gotos[i], ids.map {|id| gotos[id] }] if ids }.to_h }
+hash_reads_relation = to_relation.call(reads_relation)
+hash_includes_relation = to_relation.call(includes_relation)
+hash_direct_read_sets = to_hash.call(direct_read_sets)
+
+hash_read_sets = Lrama::Digraph.new(gotos, hash_reads_relation, hash_direct_read_sets).compute
+hash_follow_sets = Lrama::Digraph.new(gotos, hash_includes_relation, hash_read_sets).compute
+
+read_sets = Lrama::IndexedDigraph.new(size, reads_relation, direct_read_sets).compute
+follow_sets = Lrama::IndexedDigraph.new(size, includes_relation, read_sets).compute
+
+unless hash_read_sets.values_at(*gotos) == read_sets && hash_follow_sets.values_at(*gotos) == follow_sets
+  abort "IndexedDigraph result differs from Digraph"
+end
+
+puts "#{path}: #{states.states_count} states, #{size} gotos, #{iterations} iterations"
+
+Benchmark.bmbm do |x|
+  x.report("Digraph") do
+    iterations.times do
+      Lrama::Digraph.new(gotos, hash_reads_relation, hash_direct_read_sets).compute
+      Lrama::Digraph.new(gotos, hash_includes_relation, hash_read_sets).compute
+    end
+  end
+
+  x.report("IndexedDigraph") do
+    iterations.times do
+      Lrama::IndexedDigraph.new(size, reads_relation, direct_read_sets).compute
+      Lrama::IndexedDigraph.new(size, includes_relation, read_sets).compute
+    end
+  end
+end
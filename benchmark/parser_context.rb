@@ -0,0 +1,125 @@
+# frozen_string_literal: true
+
+# Compare yyparse, which sets up its stacks on every call, with
+# yyparse_context_parse on a parser context reused across many small inputs.
+# Every 16th input nests deeper than YYINITDEPTH so that the stacks grow.
+#
+#   $ ruby benchmark/parser_context.rb [ITERATIONS]
+#
+# CC and CFLAGS are taken from the environment (default: cc -O2).
+
+require "rbconfig"
+require "shellwords"
+require "tmpdir"
+
+iterations = (ARGV[0] || 1_000_000).to_i
+cc = ENV["CC"] || "cc"
+cflags = ENV["CFLAGS"] || "-O2"
+lrama = File.expand_path("../exe/lrama", __dir__)
+
+grammar = <<~'GRAMMAR'
+  %{
+  #include <stdio.h>
+  #include <stdlib.h>
+  #include <string.h>
+  #include <time.h>
+  #include "bench.h"
+
+  static const char *input;
+  static int yylex (YYSTYPE *yylval, YYLTYPE *yylloc);
+  static int yyerror (YYLTYPE *yylloc, long *result, const char *msg);
+  %}
+
+  %union {
+      long val;
+  }
+
+  %token <val> NUM
+  %type <val> expr
+  %left '+' '-'
+  %left '*'
+  %parse-param {long *result}
+  %locations
+  %define api.parser-context
+
+  %%
+
+  program : expr { *result = $1; }
+          ;
+  expr : NUM
+       | expr '+' expr { $$ = $1 + $3; }
+       | expr '-' expr { $$ = $1 - $3; }
+       | expr '*' expr { $$ = $1 * $3; }
+       | '(' expr ')'  { $$ = $2; }
+       ;
+
+  %%
+
+  static int
+  yylex (YYSTYPE *yylval, YYLTYPE *yylloc)
+  {
+    (void) yylloc;
+    if (*input >= '0' && *input <= '9')
+      {
+        yylval->val = 0;
+        while (*input >= '0' && *input <= '9')
+          yylval->val = yylval->val * 10 + (*input++ - '0');
+        return NUM;
+      }
+    return *input ? *input++ : YYEOF;
+  }
+
+  static int
+  yyerror (YYLTYPE *yylloc, long *result, const char *msg)
+  {
+    (void) yylloc;
+    (void) result;
+    fprintf (stderr, "%s\n", msg);
+    exit (1);
+  }
+
+  int
+  main (int argc, char *argv[])
+  {
+    long iterations = atol (argv[1]), sum = 0, result;
+    static char deep[1024];
+    const char *shallow = "1+2*(3-4)";
+    memset (deep, '(', 300);
+    deep[300] = '1';
+    memset (deep + 301, ')', 300);
+  #ifdef REUSE
+    yyparse_context *ctx = yyparse_context_new (64, 0);
+  #endif
+    clock_t start = clock ();
+    for (long i = 0; i < iterations; i++)
+      {
+        input = i % 16 ? shallow : deep;
+  #ifdef REUSE
+        yyparse_context_parse (ctx, &result);
+  #else
+        yyparse (&result);
+  #endif
+        sum += result;
+      }
+    printf ("%.3fs (checksum %ld)\n", (double) (clock () - start) / CLOCKS_PER_SEC, sum);
+  #ifdef REUSE
+    yyparse_context_delete (ctx);
+  #endif
+    return 0;
+  }
+GRAMMAR
+
+Dir.mktmpdir do |dir|
+  y = File.join(dir, "bench.y")
+  c = File.join(dir, "bench.c")
+  File.write(y, grammar)
+  system(RbConfig.ruby, lrama, "--header=#{File.join(dir, "bench.h")}", "-o", c, y, exception: true)
+
+  { "yyparse" => "", "yyparse_context_parse" => "-DREUSE" }.each do |label, flag|
+    exe = File.join(dir, "bench#{flag}")
+    system("#{cc} #{cflags} #{flag} -I#{dir.shellescape} -o #{exe.shellescape} #{c.shellescape}", exception: true)
+    print "#{label.ljust(22)} "
+    $stdout.flush
+    system(exe, iterations.to_s, exception: true)
+  end
+end
@@ -1,6 +1,7 @@
 # frozen_string_literal: true
 
 require_relative "lrama/bitmap"
+require_relative "lrama/bitset"
 require_relative "lrama/command"
 require_relative "lrama/context"
 require_relative "lrama/counterexamples"
@@ -8,6 +9,7 @@ require_relative "lrama/diagram"
 require_relative "lrama/digraph"
 require_relative "lrama/erb"
 require_relative "lrama/grammar"
+require_relative "lrama/indexed_digraph"
 require_relative "lrama/lexer"
 require_relative "lrama/logger"
 require_relative "lrama/option_parser"
@@ -0,0 +1,235 @@
+# rbs_inline: enabled
+# frozen_string_literal: true
+
+module Lrama
+  # Mutable fixed-width set of non-negative integers.
+  #
+  # Bits are stored in an array of words. A word holds `WORD_BITS` bits
+  # so that every word stays a Fixnum and bit operations on words don't
+  # allocate. Unlike `Bitmap`, which uses an Integer as a bitmap, `or!` and
+  # friends update the receiver in place, so merging sets of a grammar with
+  # many terminals doesn't create a new Bignum for every union.
+  class Bitset
+    include Enumerable #[Integer]
+
+    # Number of bits held by a word
+    WORD_BITS = 62 #: Integer
+
+    # @rbs!
+    #   @size: Integer
+    #   @words: Array[Integer]
+
+    attr_reader :size #: Integer
+    attr_reader :words #: Array[Integer]
+    protected :words
+
+    # @rbs (Integer size, Array[Integer] ary) -> Bitset
+    def self.from_array(size, ary)
+      bitset = new(size)
+
+      ary.each do |i|
+        bitset.set(i)
+      end
+
+      bitset
+    end
+
+    # @rbs (Integer size) -> void
+    def initialize(size)
+      @size = size
+      @words = Array.new((size + WORD_BITS - 1) / WORD_BITS, 0)
+    end
+
+    # @rbs (Bitset other) -> void
+    def initialize_copy(other)
+      super
+      @words = other.words.dup
+    end
+
+    # @rbs (Integer i) -> self
+    def set(i)
+      @words[i / WORD_BITS] |= 1 << (i % WORD_BITS)
+      self
+    end
+
+    # @rbs (Integer i) -> self
+    def unset(i)
+      @words[i / WORD_BITS] &= ~(1 << (i % WORD_BITS))
+      self
+    end
+
+    # @rbs (Integer i) -> bool
+    def include?(i)
+      return false if i < 0 || i >= @size
+
+      @words[i / WORD_BITS][i % WORD_BITS] == 1
+    end
+    alias [] include?
+
+    # @rbs () -> bool
+    def empty?
+      @words.all?(&:zero?)
+    end
+
+    # @rbs (Bitset other) -> bool
+    def intersect?(other)
+      other_words = other.words
+      i = 0
+      len = @words.size
+
+      while i < len
+        return true if @words[i] & other_words[i] != 0
+        i += 1
+      end
+
+      false
+    end
+
+    # @rbs (Bitset other) -> bool
+    def subset?(other)
+      other_words = other.words
+      i = 0
+      len = @words.size
+
+      while i < len
+        w = @words[i]
+        return false if w & other_words[i] != w
+        i += 1
+      end
+
+      true
+    end
+
+    # Merge other into self
+    #
+    # @rbs (Bitset other) -> self
+    def or!(other)
+      other_words = other.words
+      i = 0
+      len = @words.size
+
+      while i < len
+        w = other_words[i]
+        @words[i] |= w if w != 0
+        i += 1
+      end
+
+      self
+    end
+
+    # Remove bits which are not included in other from self
+    #
+    # @rbs (Bitset other) -> self
+    def and!(other)
+      other_words = other.words
+      i = 0
+      len = @words.size
+
+      while i < len
+        @words[i] &= other_words[i]
+        i += 1
+      end
+
+      self
+    end
+
+    # Remove bits which are included in other from self
+    #
+    # @rbs (Bitset other) -> self
+    def subtract!(other)
+      other_words = other.words
+      i = 0
+      len = @words.size
+
+      while i < len
+        @words[i] &= ~other_words[i]
+        i += 1
+      end
+
+      self
+    end
+
+    # @rbs (Bitset other) -> Bitset
+    def |(other)
+      dup.or!(other)
+    end
+
+    # @rbs (Bitset other) -> Bitset
+    def &(other)
+      dup.and!(other)
+    end
+
+    # @rbs (Bitset other) -> Bitset
+    def -(other)
+      dup.subtract!(other)
+    end
+
+    # Number of bits set (popcount)
+    #
+    # @rbs () -> Integer
+    def count
+      n = 0
+
+      @words.each do |w|
+        while w != 0
+          w &= w - 1
+          n += 1
+        end
+      end
+
+      n
+    end
+
+    # Yield set bits in ascending order.
+    # Each word is scanned by its lowest set bit.
+    #
+    # @rbs () { (Integer) -> void } -> void
+    #    | () -> Enumerator[Integer, void]
+    def each
+      return enum_for(:each) unless block_given?
+
+      @words.each_with_index do |w, i|
+        base = i * WORD_BITS
+
+        while w != 0
+          lowest = w & -w
+          yield base + lowest.bit_length - 1
+          w ^= lowest
+        end
+      end
+    end
+
+    # @rbs () -> Array[Integer]
+    def to_a
+      a = [] #: Array[Integer]
+      each {|i| a << i }
+      a
+    end
+
+    # @rbs (untyped other) -> bool
+    def ==(other)
+      other.is_a?(Bitset) && @size == other.size && @words == other.words
+    end
+    alias eql? ==
+
+    # @rbs () -> Integer
+    def hash
+      @words.hash
+    end
+
+    # @rbs () -> Integer
+    def to_i
+      @words.reverse_each.reduce(0) {|acc, w| (acc << WORD_BITS) | w }
+    end
+
+    # @rbs () -> String
+    def to_s
+      to_i.to_s(2)
+    end
+
+    # @rbs () -> String
+    def inspect
+      "#<#{self.class} #{to_a}>"
+    end
+  end
+end
@@ -82,10 +82,13 @@ module Lrama
     end
 
     def compute_status(grammar)
-      states = Lrama::States.new(grammar, @tracer)
+      states = Lrama::States.new(grammar, @tracer, jobs: @options.jobs)
       states.compute
       states.compute_ielr if grammar.ielr_defined?
-      [states, Lrama::Context.new(states)]
+      # yyrecover simulates the parser on the tables, so keep the repairs it finds
+      # the same as without the elimination
+      states.compute_unit_rule_elimination if grammar.unit_rule_elimination_defined? && !@options.error_recovery
+      [states, Lrama::Context.new(states, table_compression: @options.table_compression)]
     end
 
     def render_reports(states)
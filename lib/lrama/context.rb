@@ -9,12 +9,18 @@ module Lrama
 
     ErrorActionNumber = -Float::INFINITY
     BaseMin = -Float::INFINITY
+    FullWord = (1 << Bitset::WORD_BITS) - 1
+    # Value of yyrepair_dist for tokens which can not be shifted
+    RepairDistMax = 255
+    # Number of packings tried by `--table-compression=max`
+    TableCompressionAttempts = 32
 
     # TODO: It might be better to pass `states` to Output directly?
     attr_reader :states, :yylast, :yypact_ninf, :yytable_ninf, :yydefact, :yydefgoto
 
-    def initialize(states)
+    def initialize(states, table_compression: :default)
       @states = states
+      @table_compression = table_compression
       @yydefact = nil
       @yydefgoto = nil
       # Array of array
@@ -133,6 +139,86 @@ module Lrama
       @check
     end
 
+    # Uncompressed action table for `%define api.tables dense`.
+    # Index is `state * yyntokens + token` and value is same with yytable,
+    # 0 means that the default action is taken.
+    def yydense_action
+      @yydense_action ||= begin
+        pact = yypact
+
+        @states.states.flat_map do |state|
+          base = pact[state.id]
+
+          (0...yyntokens).map do |token|
+            next 0 if base == yypact_ninf
+
+            i = base + token
+            0 <= i && i <= yylast && @check[i] == token ? @table[i] : 0
+          end
+        end
+      end
+    end
+
+    # Uncompressed goto table for `%define api.tables dense`.
+    # Index is `state * yynnts + nterm` and value is the next state,
+    # default gotos are filled.
+    def yydense_goto
+      @yydense_goto ||= begin
+        pgoto = yypgoto
+
+        @states.states.flat_map do |state|
+          (0...yynnts).map do |nterm|
+            i = pgoto[nterm] + state.id
+            0 <= i && i <= yylast && @check[i] == state.id ? @table[i] : @yydefgoto[nterm]
+          end
+        end
+      end
+    end
+
+    # Actions which are not the default action, used by `bison/yacc-direct.c`.
+    # Index is state id, value is an array of [term number, action number].
+    # Action number is same with compute_yydefact.
+    def direct_actions
+      @direct_actions ||= begin
+        actions = Array.new(@states.states.count) { [] }
+
+        @_actions.each do |vector, froms_and_tos, _, _|
+          actions[vector] = froms_and_tos if vector < @states.states.count
+        end
+
+        actions
+      end
+    end
+
+    # Gotos which are not the default goto, used by `bison/yacc-direct.c`.
+    # Index is sequence number of nterm, value is an array of [from state id, to state id].
+    def direct_gotos
+      @direct_gotos ||= begin
+        gotos = Array.new(@states.nterms.count) { [] }
+
+        @_actions.each do |vector, froms_and_tos, _, _|
+          gotos[vector - @states.states.count] = froms_and_tos if vector >= @states.states.count
+        end
+
+        gotos
+      end
+    end
+
+    # Lower bounds of the number of tokens yyrecover has to insert before
+    # a token can be shifted, used to guide the repair search.
+    # Rows are shared between states, index is `yyrepair_dist_row[state] * yyntokens + token`.
+    # RepairDistMax means the token can never be shifted.
+    def yyrepair_dist
+      compute_repair_dist unless @yyrepair_dist
+      @yyrepair_dist
+    end
+
+    # Row of yyrepair_dist for each state.
+    def yyrepair_dist_row
+      compute_repair_dist unless @yyrepair_dist_row
+      @yyrepair_dist_row
+    end
+
     def yystos
       @states.states.map do |state|
         state.accessing_symbol.number
@@ -165,6 +251,24 @@ module Lrama
       return a
     end
 
+    # Mapping from rule number to 1 if the action refers to any location.
+    # Dummy rule is appended as the first element whose value is 0.
+    def yyrloc
+      a = [0]
+
+      @states.rules.each do |rule|
+        a << (rule.contains_at_reference? ? 1 : 0)
+      end
+
+      return a
+    end
+
+    # Id of the next state of the transition.
+    # States only reducing by a unit rule are bypassed if States#compute_unit_rule_elimination is done.
+    def next_state_id(state, transition)
+      (state.unit_rule_bypasses[transition.next_sym]&.first || transition.to_state).id
+    end
+
     private
 
     # Compute these
@@ -220,56 +324,53 @@ module Lrama
         # * number > 0, shift then move to state "number"
         # * number < 0, reduce by "-number" rule. Rule "number" is already added by 1.
         actions = Array.new(@states.terms.count, 0)
+        # Term numbers whose action is set
+        set_terms = Bitset.new(@states.terms.count)
 
-        if state.reduces.map(&:selected_look_ahead).any? {|la| !la.empty? }
+        if state.reduces.any?(&:selected_look_ahead?)
           # Iterate reduces with reverse order so that first rule is used.
           state.reduces.reverse_each do |reduce|
-            reduce.look_ahead.each do |term|
-              actions[term.number] = rule_id_to_action_number(reduce.rule.id)
+            look_ahead = reduce.look_ahead_bitmap
+            next unless look_ahead
+
+            action_number = rule_id_to_action_number(reduce.rule.id)
+            look_ahead.each do |number|
+              actions[number] = action_number
             end
+            set_terms.or!(look_ahead)
           end
         end
 
         # Shift is selected when S/R conflict exists.
         state.selected_term_transitions.each do |shift|
-          actions[shift.next_sym.number] = shift.to_state.id
+          actions[shift.next_sym.number] = next_state_id(state, shift)
+          set_terms.set(shift.next_sym.number)
         end
 
         state.resolved_conflicts.select do |conflict|
           conflict.which == :error
         end.each do |conflict|
           actions[conflict.symbol.number] = ErrorActionNumber
+          set_terms.set(conflict.symbol.number)
         end
 
-        # If default_reduction_rule, replace default_reduction_rule in
-        # actions with zero.
-        if state.default_reduction_rule
-          actions.map! do |e|
-            if e == rule_id_to_action_number(state.default_reduction_rule.id)
-              0
-            else
-              e
-            end
-          end
-        end
-
+        # If default_reduction_rule, entries of default_reduction_rule
+        # are removed because they are the default action.
         # If no default_reduction_rule, default behavior is an
-        # error then replace ErrorActionNumber with zero.
-        unless state.default_reduction_rule
-          actions.map! do |e|
-            if e == ErrorActionNumber
-              0
-            else
-              e
-            end
+        # error then ErrorActionNumber entries are removed.
+        default_action_number =
+          if state.default_reduction_rule
+            rule_id_to_action_number(state.default_reduction_rule.id)
+          else
+            ErrorActionNumber
           end
-        end
 
-        s = actions.each_with_index.map do |n, i|
-          [i, n]
-        end.reject do |i, n|
-          # Remove default_reduction_rule entries
-          n == 0
+        s = []
+        set_terms.each do |i|
+          n = actions[i]
+          next if n == 0 || n == default_action_number
+
+          s << [i, n]
         end
 
         if s.count != 0
@@ -298,7 +399,7 @@ module Lrama
         state.nterm_transitions.each do |goto|
           key = goto.next_sym
           nterm_to_to_states[key] ||= []
-          nterm_to_to_states[key] << [state, goto.to_state] # [from_state, to_state]
+          nterm_to_to_states[key] << [state, @states.states[next_state_id(state, goto)]] # [from_state, to_state]
         end
       end
 
@@ -334,36 +435,12 @@ module Lrama
     end
 
     def sort_actions
-      # This is not same with #sort_actions
-      #
-      # @sorted_actions = @_actions.sort_by do |_, _, count, width|
-      #   [-width, -count]
-      # end
-
-      @sorted_actions = []
-
-      @_actions.each do |action|
-        if @sorted_actions.empty?
-          @sorted_actions << action
-          next
-        end
-
-        j = @sorted_actions.count - 1
-        _state_id, _froms_and_tos, count, width = action
-
-        while (j >= 0) do
-          case
-          when @sorted_actions[j][3] < width
-            j -= 1
-          when @sorted_actions[j][3] == width && @sorted_actions[j][2] < count
-            j -= 1
-          else
-            break
-          end
-        end
-
-        @sorted_actions.insert(j + 1, action)
-      end
+      # Sort by width then count in descending order.
+      # Actions of the same width and count keep their original order,
+      # index is added to the key because `sort_by` is not stable.
+      @sorted_actions = @_actions.each_with_index.sort_by do |(_, _, count, width), i|
+        [-width, -count, i]
+      end.map(&:first)
     end
 
     def debug_sorted_actions
@@ -397,27 +474,75 @@ module Lrama
     end
 
     def compute_packed_table
+      @base, @table, @check, @yylast = pack_table(@sorted_actions)
+
+      if @table_compression == :max
+        # Keep the first packing which has the smallest table
+        each_compression_candidate do |sorted_actions|
+          packed = pack_table(sorted_actions)
+          @base, @table, @check, @yylast = packed if packed[3] < @yylast
+        end
+      end
+
+      # replace_ninf
+      @yypact_ninf = (@base.reject {|i| i == BaseMin } + [0]).min - 1
+      @base.map! do |i|
+        case i
+        when BaseMin
+          @yypact_ninf
+        else
+          i
+        end
+      end
+
+      @yytable_ninf = (@table.compact.reject {|i| i == ErrorActionNumber } + [0]).min - 1
+      @table.map! do |i|
+        case i
+        when nil
+          0
+        when ErrorActionNumber
+          @yytable_ninf
+        else
+          i
+        end
+      end
+
+      @check.map! do |i|
+        case i
+        when nil
+          -1
+        else
+          i
+        end
+      end
+    end
+
+    # First-fit packing of actions into yytable and yycheck.
+    # Return bases of vectors (yypact and yypgoto), yytable, yycheck and yylast.
+    def pack_table(sorted_actions)
       # yypact and yypgoto
-      @base = Array.new(vectors_count, BaseMin)
+      base = Array.new(vectors_count, BaseMin)
       # yytable
-      @table = []
+      table = []
       # yycheck
-      @check = []
+      check = []
       # Key is froms_and_tos, value is index position
       pushed = {}
       used_res = {}
       lowzero = 0
       high = 0
+      # Bitset of used `table` slots, to jump to the next empty slot
+      occupied = []
 
-      @sorted_actions.each do |state_id, froms_and_tos, _, _|
+      sorted_actions.each do |state_id, froms_and_tos, _, _|
         if (res = pushed[froms_and_tos])
-          @base[state_id] = res
+          base[state_id] = res
           next
         end
 
         res = lowzero - froms_and_tos.first[0]
 
-        # Find the smallest `res` such that `@table[res + from]` is empty for all `from` in `froms_and_tos`
+        # Find the smallest `res` such that `table[res + from]` is empty for all `from` in `froms_and_tos`
         while true do
           advanced = false
 
@@ -427,10 +552,16 @@ module Lrama
           end
 
           froms_and_tos.each do |from, to|
-            while @table[res + from]
-              res += 1
-              advanced = true
-            end
+            next unless table[res + from]
+
+            # Any `res` before the next empty slot for `from` also conflicts, so skip them.
+            # Most runs of used slots are short, so check a few slots before scanning words.
+            loc = res + from + 1
+            limit = loc + 8
+            loc += 1 while loc < limit && table[loc]
+            loc = next_empty_slot(occupied, loc) if table[loc]
+            res = loc - from
+            advanced = true
           end
 
           unless advanced
@@ -444,54 +575,147 @@ module Lrama
         froms_and_tos.each do |from, to|
           loc = res + from
 
-          @table[loc] = to
-          @check[loc] = from
+          table[loc] = to
+          check[loc] = from
+          index = loc / Bitset::WORD_BITS
+          occupied[index] = (occupied[index] || 0) | (1 << (loc % Bitset::WORD_BITS))
         end
 
-        while (@table[lowzero]) do
-          lowzero += 1
-        end
+        lowzero = next_empty_slot(occupied, lowzero)
 
         high = loc if high < loc
 
-        @base[state_id] = res
+        base[state_id] = res
         pushed[froms_and_tos] = res
         used_res[res] = true
       end
 
-      @yylast = high
+      [base, table, check, high]
+    end
 
-      # replace_ninf
-      @yypact_ninf = (@base.reject {|i| i == BaseMin } + [0]).min - 1
-      @base.map! do |i|
-        case i
-        when BaseMin
-          @yypact_ninf
-        else
-          i
+    # Orders of actions tried by `--table-compression=max`.
+    # First-fit packing depends on the order of actions having the same width,
+    # so they are shuffled, or widths are jittered to mix similar widths.
+    # Random is seeded so that the output is reproducible.
+    def each_compression_candidate
+      random = Random.new(0)
+
+      (1...TableCompressionAttempts).each do |attempt|
+        sorted_actions = @_actions.each_with_index.sort_by do |(_, _, count, width), i|
+          if attempt.odd?
+            [-width, -count, random.rand]
+          else
+            [-width * (1 + random.rand * 0.3), i]
+          end
         end
+
+        yield sorted_actions.map(&:first)
       end
+    end
 
-      @yytable_ninf = (@table.compact.reject {|i| i == ErrorActionNumber } + [0]).min - 1
-      @table.map! do |i|
-        case i
-        when nil
-          0
-        when ErrorActionNumber
-          @yytable_ninf
-        else
-          i
+    # Compute yyrepair_dist by 0-1 BFS toward the states shifting each token
+    # on a relaxation of the parser:
+    #
+    # * Inserting a token costs 1 and moves to the state shifting it.
+    # * Reducing to an nterm costs 0 and may move to any state reached by a goto on the nterm,
+    #   because states under the top of the stack are not known.
+    #
+    # Every run of the parser is a path of this graph, then distances are not greater than actual ones.
+    def compute_repair_dist
+      nstates = @states.states.count
+      ntokens = yyntokens
+      r1 = yyr1
+      error = @states.error_symbol.number
+      # Edges are reversed, from the destination to the source.
+      # Nodes are states and nterms, nterm of sequence number `k` is node `nstates + k`.
+      zero_edges = Array.new(nstates + yynnts) { [] }
+      one_edges = Array.new(nstates + yynnts) { [] }
+      shifts = Array.new(ntokens) { [] }
+
+      @states.states.each do |state|
+        reduced = []
+        reduced << r1[@yydefact[state.id]] if @yydefact[state.id] != 0
+
+        direct_actions[state.id].each do |term, n|
+          if n == ErrorActionNumber
+            next
+          elsif n > 0
+            shifts[term] << state.id
+            one_edges[n] << state.id unless term == error
+          else
+            reduced << r1[-n]
+          end
+        end
+
+        reduced.uniq.each do |nterm_number|
+          zero_edges[nstates + nterm_number_to_sequence_number(nterm_number)] << state.id
+        end
+
+        state.nterm_transitions.each do |goto|
+          zero_edges[next_state_id(state, goto)] << nstates + nterm_number_to_sequence_number(goto.next_sym.number)
+        end
+      end
+      # Default gotos of nterms without transitions, e.g. $accept, are followed by yyrecover too
+      @yydefgoto.each_with_index {|to, k| zero_edges[to] << nstates + k }
+      zero_edges.each(&:uniq!)
+
+      dist = Array.new(nstates) { Array.new(ntokens, RepairDistMax) }
+
+      ntokens.times do |token|
+        d = Array.new(nstates + yynnts, RepairDistMax)
+        level = 0
+        current = shifts[token].uniq
+        current.each {|node| d[node] = 0 }
+
+        until current.empty? || level >= RepairDistMax
+          # `current` grows while nodes of the same distance are visited
+          current.each do |node|
+            zero_edges[node].each do |from|
+              next if d[from] <= level
+              d[from] = level
+              current << from
+            end
+          end
+
+          following = []
+          current.each do |node|
+            one_edges[node].each do |from|
+              next if d[from] <= level + 1
+              d[from] = level + 1
+              following << from
+            end
+          end
+
+          current = following
+          level += 1
         end
+
+        nstates.times {|id| dist[id][token] = d[id] }
       end
 
-      @check.map! do |i|
-        case i
-        when nil
-          -1
-        else
-          i
+      rows = {}
+      @yyrepair_dist = []
+      @yyrepair_dist_row = dist.map do |row|
+        rows[row] ||= begin
+          @yyrepair_dist.concat(row)
+          rows.count
         end
       end
     end
+
+    # Return the smallest slot not less than `loc` which is not set in `occupied`
+    def next_empty_slot(occupied, loc)
+      index = loc / Bitset::WORD_BITS
+      # Treat slots before `loc` as occupied
+      word = (occupied[index] || 0) | ((1 << (loc % Bitset::WORD_BITS)) - 1)
+
+      while word == FullWord
+        index += 1
+        word = occupied[index] || 0
+      end
+
+      # Lowest unset bit of the word
+      index * Bitset::WORD_BITS + (~word & (word + 1)).bit_length - 1
+    end
   end
 end
@@ -24,12 +24,11 @@ module Lrama
     #   @total_duration: Float
     #   @exceed_cumulative_time_limit: bool
     #   @state_items: Hash[[State, State::Item], StateItem]
-    #   @triples: Hash[Integer, Triple]
+    #   @triples: Array[Hash[Bitset, Triple]?]
     #   @transitions: Hash[[StateItem, Grammar::Symbol], StateItem]
     #   @reverse_transitions: Hash[[StateItem, Grammar::Symbol], Set[StateItem]]
     #   @productions: Hash[StateItem, Set[StateItem]]
     #   @reverse_productions: Hash[[State, Grammar::Symbol], Set[StateItem]] # Grammar::Symbol is nterm
-    #   @state_item_shift: Integer
 
     attr_reader :transitions #: Hash[[StateItem, Grammar::Symbol], StateItem]
     attr_reader :productions #: Hash[StateItem, Set[StateItem]]
@@ -40,7 +39,7 @@ module Lrama
       @iterate_count = 0
       @total_duration = 0
       @exceed_cumulative_time_limit = false
-      @triples = {}
+      @triples = []
       setup_state_items
       setup_transitions
       setup_productions
@@ -97,8 +96,6 @@ module Lrama
           count += 1
         end
       end
-
-      @state_item_shift = Math.log(count, 2).ceil
     end
 
     # @rbs () -> void
@@ -170,10 +167,10 @@ module Lrama
     # Do not create new Triple instance anywhere else
     # to avoid miss hash lookup.
     #
-    # @rbs (StateItem state_item, Bitmap::bitmap precise_lookahead_set) -> Triple
+    # @rbs (StateItem state_item, Bitset precise_lookahead_set) -> Triple
     def get_triple(state_item, precise_lookahead_set)
-      key = (precise_lookahead_set << @state_item_shift) | state_item.id
-      @triples[key] ||= Triple.new(state_item, precise_lookahead_set)
+      triples = (@triples[state_item.id] ||= {})
+      triples[precise_lookahead_set] ||= Triple.new(state_item, precise_lookahead_set)
     end
 
     # @rbs (State conflict_state, State::ShiftReduceConflict conflict) -> Example
@@ -331,10 +328,9 @@ module Lrama
       queue = [] #: Array[[Triple, Path]]
       visited = {} #: Hash[Triple, true]
       start_state = @states.states.first #: Lrama::State
-      conflict_term_bit = Bitmap::from_integer(conflict_term.number)
       raise "BUG: Start state should be just one kernel." if start_state.kernels.count != 1
       reachable = reachable_state_items(get_state_item(conflict_state, conflict_reduce_item))
-      start = get_triple(get_state_item(start_state, start_state.kernels.first), Bitmap::from_integer(@states.eof_symbol.number))
+      start = get_triple(get_state_item(start_state, start_state.kernels.first), @states.eof_symbol.first_set_bitmap)
 
       queue << [start, Path.new(start.state_item, nil)]
 
@@ -342,7 +338,7 @@ module Lrama
         @iterate_count += 1
 
         # Found
-        if (triple.state == conflict_state) && (triple.item == conflict_reduce_item) && (triple.l & conflict_term_bit != 0)
+        if (triple.state == conflict_state) && (triple.item == conflict_reduce_item) && triple.l.include?(conflict_term.number)
           state_items = [path.state_item]
 
           while (path = path.parent)
@@ -388,7 +384,7 @@ module Lrama
       return nil
     end
 
-    # @rbs (State::Item item, Bitmap::bitmap current_l) -> Bitmap::bitmap
+    # @rbs (State::Item item, Bitset current_l) -> Bitset
     def follow_l(item, current_l)
       # 1. follow_L (A -> X1 ... Xn-1 • Xn) = L
       # 2. follow_L (A -> X1 ... Xk • Xk+1 Xk+2 ... Xn) = {Xk+2} if Xk+2 is a terminal
@@ -398,7 +394,7 @@ module Lrama
       when item.number_of_rest_symbols == 1
         current_l
       when item.next_next_sym.term?
-        item.next_next_sym.number_bitmap
+        item.next_next_sym.first_set_bitmap
       when !item.next_next_sym.nullable
         item.next_next_sym.first_set_bitmap
       else
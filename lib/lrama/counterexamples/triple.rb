@@ -4,11 +4,11 @@
 module Lrama
   class Counterexamples
     class Triple
-      attr_reader :precise_lookahead_set #: Bitmap::bitmap
+      attr_reader :precise_lookahead_set #: Bitset
 
       alias :l :precise_lookahead_set
 
-      # @rbs (StateItem state_item, Bitmap::bitmap precise_lookahead_set) -> void
+      # @rbs (StateItem state_item, Bitset precise_lookahead_set) -> void
       def initialize(state_item, precise_lookahead_set)
         @state_item = state_item
         @precise_lookahead_set = precise_lookahead_set
@@ -33,7 +33,7 @@ module Lrama
 
       # @rbs () -> ::String
       def inspect
-        "#{state.inspect}. #{item.display_name}. #{l.to_s(2)}"
+        "#{state.inspect}. #{item.display_name}. #{l.to_s}"
       end
       alias :to_s :inspect
     end
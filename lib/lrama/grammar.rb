@@ -31,6 +31,7 @@ module Lrama
     #     def rules: () -> Array[Rule]
     #     def accept_symbol: () -> Grammar::Symbol
     #     def eof_symbol: () -> Grammar::Symbol
+    #     def error_symbol: () -> Grammar::Symbol
     #     def undef_symbol: () -> Grammar::Symbol
     #     def precedences: () -> Array[Precedence]
     #
@@ -304,6 +305,36 @@ module Lrama
       @define.key?('lr.type') && @define['lr.type'] == 'ielr'
     end
 
+    # @rbs () -> bool
+    def dense_tables_defined?
+      @define.key?('api.tables') && @define['api.tables'] == 'dense'
+    end
+
+    # @rbs () -> bool
+    def push_parser_defined?
+      @define.key?('api.push-pull') && %w[push both].include?(@define['api.push-pull'])
+    end
+
+    # @rbs () -> bool
+    def pull_parser_defined?
+      !@define.key?('api.push-pull') || %w[pull both].include?(@define['api.push-pull'])
+    end
+
+    # @rbs () -> bool
+    def parser_context_defined?
+      @define.key?('api.parser-context') && @define['api.parser-context'] != 'false' && !push_parser_defined?
+    end
+
+    # @rbs () -> bool
+    def unit_rule_elimination_defined?
+      @define.key?('lr.unit-rule-elimination') && @define['lr.unit-rule-elimination'] != 'false'
+    end
+
+    # @rbs () -> bool
+    def compact_location_defined?
+      @define.key?('api.location.type') && @define['api.location.type'] == 'compact'
+    end
+
     private
 
     # @rbs () -> void
@@ -368,12 +399,12 @@ module Lrama
     def compute_first_set
       terms.each do |term|
         term.first_set = Set.new([term]).freeze
-        term.first_set_bitmap = Lrama::Bitmap.from_array([term.number])
+        term.first_set_bitmap = Lrama::Bitset.from_array(terms.count, [term.number])
       end
 
       nterms.each do |nterm|
         nterm.first_set = Set.new([]).freeze
-        nterm.first_set_bitmap = Lrama::Bitmap.from_array([])
+        nterm.first_set_bitmap = Lrama::Bitset.new(terms.count)
       end
 
       while true do
@@ -381,9 +412,9 @@ module Lrama
 
         @rules.each do |rule|
           rule.rhs.each do |r|
-            if rule.lhs.first_set_bitmap | r.first_set_bitmap != rule.lhs.first_set_bitmap
+            unless r.first_set_bitmap.subset?(rule.lhs.first_set_bitmap)
               changed = true
-              rule.lhs.first_set_bitmap = rule.lhs.first_set_bitmap | r.first_set_bitmap
+              rule.lhs.first_set_bitmap.or!(r.first_set_bitmap)
             end
 
             break unless r.nullable
@@ -394,7 +425,7 @@ module Lrama
       end
 
       nterms.each do |nterm|
-        nterm.first_set = Lrama::Bitmap.to_array(nterm.first_set_bitmap).map do |number|
+        nterm.first_set = nterm.first_set_bitmap.map do |number|
           find_symbol_by_number!(number)
         end.to_set
       end
@@ -595,9 +626,14 @@ module Lrama
       raise errors.join("\n")
     end
 
+    # Locations are enabled by `%locations` or any `@` reference.
+    # Without them yyparse keeps no location stack.
+    #
     # @rbs () -> void
     def set_locations
-      @locations = @locations || @rules.any? {|rule| rule.contains_at_reference? }
+      @locations = @locations ||
+        @rules.any? {|rule| rule.contains_at_reference? } ||
+        (@printers + @destructors + @error_tokens).any? {|code| code.token_code.references.any? {|r| r.type == :at } }
     end
   end
 end
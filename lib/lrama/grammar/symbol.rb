@@ -11,8 +11,7 @@ module Lrama
     class Symbol
       attr_accessor :id #: Lexer::Token::Base
       attr_accessor :alias_name #: String?
-      attr_reader :number #: Integer
-      attr_accessor :number_bitmap #: Bitmap::bitmap
+      attr_accessor :number #: Integer
       attr_accessor :tag #: Lexer::Token::Tag?
       attr_accessor :token_id #: Integer
       attr_accessor :nullable #: bool
@@ -21,7 +20,7 @@ module Lrama
       attr_accessor :destructor #: Destructor?
       attr_accessor :error_token #: ErrorToken
       attr_accessor :first_set #: Set[Grammar::Symbol]
-      attr_accessor :first_set_bitmap #: Bitmap::bitmap
+      attr_accessor :first_set_bitmap #: Bitset
       attr_reader :term #: bool
       attr_writer :eof_symbol #: bool
       attr_writer :error_symbol #: bool
@@ -43,12 +42,6 @@ module Lrama
         @destructor = destructor
       end
 
-      # @rbs (Integer) -> void
-      def number=(number)
-        @number = number
-        @number_bitmap = Bitmap::from_integer(number)
-      end
-
       # @rbs () -> bool
       def term?
         term
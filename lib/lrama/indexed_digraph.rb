@@ -0,0 +1,153 @@
+# rbs_inline: enabled
+# frozen_string_literal: true
+
+module Lrama
+  # Non-recursive variant of Digraph whose nodes are integers `0...size`.
+  #
+  # It computes the same result as Digraph, but
+  #
+  # * nodes, edges and attributes are stored in arrays indexed by node id,
+  # * traversal uses an explicit stack instead of recursion
+  #   so that deep graphs do not exhaust the Ruby stack,
+  # * attributes are merged in place when they support `#or!`,
+  #   otherwise `#|` is used. Base attributes are copied before
+  #   the first in-place merge, so `base_function` is never modified.
+  #
+  # @rbs generic Y < _Or -- Type of attribute sets assigned to a node which should support merge operation (#| method)
+  class IndexedDigraph
+    # TODO: rbs-inline 0.11.0 doesn't support instance variables.
+    #       Move these type declarations above instance variable definitions, once it's supported.
+    #       see: https://github.com/soutaro/rbs-inline/pull/149
+    #
+    # @rbs!
+    #   interface _Or
+    #     def |: (self) -> self
+    #   end
+    #   @size: Integer
+    #   @relation: Array[Array[Integer]?]
+    #   @base_function: Array[Y]
+    #   @in_place: bool
+    #   @stack: Array[Integer]
+    #   @h: Array[Integer]
+    #   @d: Array[Integer]
+    #   @result: Array[Y]
+    #   @owned: Array[bool]
+
+    # @rbs size: Integer -- Number of nodes of graph
+    # @rbs relation: Array[Array[Integer]?] -- Edges of graph
+    # @rbs base_function: Array[Y] -- Attributes of nodes
+    # @rbs return: void
+    def initialize(size, relation, base_function)
+      @size = size
+
+      # R in the paper
+      @relation = relation
+
+      # F' in the paper
+      @base_function = base_function
+      @in_place = !base_function.empty? && base_function.all? {|y| y.respond_to?(:or!) }
+
+      # S in the paper
+      @stack = []
+
+      # N in the paper
+      @h = Array.new(size, 0)
+
+      # Depth of the stack when a node is visited
+      @d = Array.new(size, 0)
+
+      # F in the paper
+      @result = Array.new(size)
+
+      # Whether F x is a copy owned by the graph, only used when merging in place
+      @owned = Array.new(size, false)
+    end
+
+    # @rbs () -> Array[Y]
+    def compute
+      @size.times do |x|
+        next if @h[x] != 0
+        traverse(x)
+      end
+
+      return @result
+    end
+
+    private
+
+    # @rbs (Integer x) -> void
+    def traverse(x)
+      relation = @relation
+      h = @h
+      result = @result
+
+      # Nodes under traversal and the next edge index of each of them.
+      # They are kept in one flat array as pairs of `node, edge_index`.
+      work = [x, 0]
+      visit(x)
+
+      while (v = work[-2])
+        edges = relation[v]
+        i = work[-1]
+
+        if edges && i < edges.size
+          work[-1] = i + 1
+          y = edges[i]
+
+          if h[y] == 0
+            work.push(y, 0)
+            visit(y)
+            next
+          end
+        else
+          work.pop(2)
+          close(v) if h[v] == @d[v]
+          y = v
+          v = work[-2]
+          break unless v
+        end
+
+        # Merge attributes of y into v
+        h[v] = h[y] if h[y] < h[v]
+        fv = result[v]
+        fy = result[y]
+        next if fv.equal?(fy)
+
+        # F x = F x + F y
+        if @in_place
+          # Base attributes are shared until the first merge
+          unless @owned[v]
+            fv = result[v] = fv.dup
+            @owned[v] = true
+          end
+
+          fv.or!(fy) # steep:ignore NoMethod
+        else
+          result[v] = fv | fy
+        end
+      end
+    end
+
+    # @rbs (Integer x) -> void
+    def visit(x)
+      @stack.push(x)
+      d = @stack.size
+      @h[x] = d
+      @d[x] = d
+      # F x = F' x
+      @result[x] = @base_function[x]
+    end
+
+    # Pop the SCC whose root is x
+    #
+    # @rbs (Integer x) -> void
+    def close(x)
+      while (z = @stack.pop) do
+        # Larger than any depth
+        @h[z] = @size + 1
+        break if z == x
+        @result[z] = @result[x] # F (Top of S) = F x
+      end
+    end
+  end
+end
@@ -104,6 +104,7 @@ module Lrama
         o.on_tail '    none                             disable all reports'
         o.on('--report-file=FILE', 'also produce details on the automaton output to a file named FILE') {|v| @options.report_file = v }
         o.on('-o', '--output=FILE', 'leave output to FILE') {|v| @options.outfile = v }
+        o.on('--table-compression=LEVEL', %w[default max], 'compress parser tables at LEVEL (default, max)') {|v| @options.table_compression = v.to_sym }
         o.on('--trace=TRACES', Array, 'also output trace logs at runtime') {|v| @trace = v }
         o.on_tail ''
         o.on_tail 'TRACES is a list of comma-separated words that can include:'
@@ -133,6 +134,10 @@ module Lrama
         o.on('-e', 'enable error recovery') {|v| @options.error_recovery = true }
         o.separator ''
         o.separator 'Other options:'
+        o.on('-j', '--jobs=N', Integer, 'use N worker processes to build states') do |v|
+          raise "Invalid jobs option \"#{v}\". It must be a positive integer." unless v > 0
+          @options.jobs = v
+        end
         o.on('-V', '--version', "output version information and exit") {|v| puts "lrama #{Lrama::VERSION}"; exit 0 }
         o.on('-h', '--help', "display this help and exit") {|v| puts o; exit 0 }
         o.on_tail
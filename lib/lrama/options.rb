@@ -21,6 +21,8 @@ module Lrama
     attr_accessor :diagram #: bool
     attr_accessor :diagram_file #: String
     attr_accessor :profile_opts #: Hash[Symbol, bool]?
+    attr_accessor :jobs #: Integer
+    attr_accessor :table_compression #: Symbol
 
     # @rbs () -> void
     def initialize
@@ -41,6 +43,8 @@ module Lrama
       @diagram = false
       @diagram_file = "diagram.html"
       @profile_opts = nil
+      @jobs = 1
+      @table_compression = :default
     end
   end
 end
@@ -13,7 +13,9 @@ module Lrama
     def_delegators "@context", :yyfinal, :yylast, :yyntokens, :yynnts, :yynrules, :yynstates,
                                :yymaxutok, :yypact_ninf, :yytable_ninf
 
-    def_delegators "@grammar", :eof_symbol, :error_symbol, :undef_symbol, :accept_symbol
+    def_delegators "@grammar", :eof_symbol, :error_symbol, :undef_symbol, :accept_symbol, :dense_tables_defined?,
+                               :push_parser_defined?, :pull_parser_defined?, :parser_context_defined?,
+                               :compact_location_defined?
 
     def initialize(
       out:, output_file_path:, template_name:, grammar_file_path:,
@@ -259,6 +261,109 @@ module Lrama
       STR
     end
 
+    # Whether yyparse is rendered as a directly-executable parser
+    def direct_parser?
+      template_basename == "yacc-direct.c"
+    end
+
+    # Jump from yystate to the code of the state
+    def direct_state_dispatch
+      @context.states.states.map do |state|
+        "      case #{state.id}: goto yystate_#{state.id};\n"
+      end.join
+    end
+
+    # Code of each state for the directly-executable parser.
+    #
+    # * yyshift_N: shift the lookahead token then push state N
+    # * yyenter_N: push state N, the generic path is used when the stack grows
+    # * yystate_N: take the action of state N on the lookahead token
+    def direct_states
+      shift_targets = @context.direct_actions.flat_map do |actions|
+        actions.map(&:last).select {|n| n > 0 }
+      end.to_set
+      enter_targets = @context.states.states.flat_map do |state|
+        state.nterm_transitions.map {|goto| @context.next_state_id(state, goto) }
+      end.to_set
+
+      @context.states.states.map do |state|
+        id = state.id
+        code = +""
+
+        if shift_targets.include?(id)
+          code << <<-STR
+yyshift_#{id}:
+  if (yyerrstatus)
+    yyerrstatus--;
+  YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc#{user_args});
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  *++yyvsp = yylval;
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
+          STR
+          code << "  *++yylsp = yylloc;\n" if @grammar.locations
+          code << after_shift_function("/* %after-shift code. */")
+          code << "  yychar = YYEMPTY;\n"
+        end
+
+        if enter_targets.include?(id)
+          code << "yyenter_#{id}:\n"
+        end
+
+        if id == @context.yyfinal
+          code << <<-STR
+  yystate = #{id};
+  goto yynewstate;
+          STR
+        elsif shift_targets.include?(id) || enter_targets.include?(id)
+          code << <<-STR
+  yystate = #{id};
+  if (yyss + yystacksize - 2 <= yyssp)
+    goto yynewstate;
+  *++yyssp = #{id};
+  YYDPRINTF ((stderr, "Entering state %d\\n", yystate));
+  YY_STACK_PRINT (yyss, yyssp#{user_args});
+          STR
+        end
+
+        code << "yystate_#{id}:\n"
+        code << direct_state_actions(state)
+        code << "\n"
+      end.join
+    end
+
+    # Goto after a reduction, switch by lhs then by the state on the stack top
+    def direct_gotos
+      goto_nterms = @context.states.states.flat_map do |state|
+        state.nterm_transitions.map(&:next_sym)
+      end.to_set
+
+      @context.states.nterms.map do |nterm|
+        next unless goto_nterms.include?(nterm)
+
+        k = nterm.number - yyntokens
+        default_goto = "goto yyenter_#{@context.yydefgoto[k]};"
+        gotos = @context.direct_gotos[k]
+
+        if gotos.empty?
+          "      case #{nterm.enum_name}: #{default_goto}\n"
+        else
+          cases = gotos.group_by(&:last).map do |to, froms|
+            labels = froms.map {|from, _| "            case #{from}:\n" }.join
+            "#{labels}              goto yyenter_#{to};\n"
+          end.join
+
+          <<-STR
+      case #{nterm.enum_name}:
+        switch (*yyssp)
+          {
+#{cases}            default:
+              #{default_goto}
+          }
+          STR
+        end
+      end.join
+    end
+
     def omit_blanks(param)
       param.strip
     end
@@ -403,6 +508,47 @@ module Lrama
 
     private
 
+    def direct_state_actions(state)
+      default_action =
+        if (rule_id = @context.yydefact[state.id]) != 0
+          "yyn = #{rule_id};\n  goto yyreduce;"
+        else
+          "goto yyerrlab;"
+        end
+      actions = @context.direct_actions[state.id]
+
+      return "  #{default_action}\n" if actions.empty?
+
+      cases = actions.group_by(&:last).map do |n, terms|
+        labels = terms.map do |term, _|
+          sym = @grammar.find_symbol_by_number!(term)
+          "      case #{sym.enum_name}: /* #{sym.display_name} */\n"
+        end.join
+        action =
+          case
+          when n == Context::ErrorActionNumber
+            "goto yyerrlab;"
+          when n > 0
+            "goto yyshift_#{n};"
+          else
+            "yyn = #{-n};\n        goto yyreduce;"
+          end
+
+        "#{labels}        #{action}\n"
+      end.join
+
+      <<-STR
+  if (yychar == YYEMPTY)
+    goto yyread;
+  yytoken = YYTRANSLATE (yychar);
+  switch (yytoken)
+    {
+#{cases}      default:
+        #{default_action.gsub("\n  ", "\n        ")}
+    }
+      STR
+    end
+
     def eval_template(file, path)
       tmp = ERB.render(file, context: @context, output: self)
       replace_special_variables(tmp, path)
@@ -28,6 +28,7 @@ module Lrama
           report_nonassoc_errors(io, state)
           report_reduces(io, state)
           report_nterm_transitions(io, state)
+          report_unit_rule_bypasses(io, state)
           report_conflict_resolutions(io, state) if @solved
           report_counterexamples(io, state, cex) if @counterexamples && state.has_conflicts? # @type var cex: Lrama::Counterexamples
           report_verbose_info(io, state, states) if @verbose
@@ -211,6 +212,19 @@ module Lrama
         io << "\n"
       end
 
+      # @rbs (IO io, Lrama::State state) -> void
+      def report_unit_rule_bypasses(io, state)
+        return if state.unit_rule_bypasses.empty?
+
+        bypasses = state.unit_rule_bypasses.sort_by {|sym, _| sym.number }
+        max_len = bypasses.map {|sym, _| sym.display_name.length }.max
+        bypasses.each do |sym, (to_state, count)|
+          io << "    #{sym.display_name.ljust(max_len)}  go to state #{to_state.id} instead of state #{state.transition(sym).id}, #{count} unit rule reduction#{count == 1 ? "" : "s"} removed\n"
+        end
+
+        io << "\n"
+      end
+
       # @rbs (IO io, Lrama::State state) -> void
       def report_conflict_resolutions(io, state)
         return if state.resolved_conflicts.empty?
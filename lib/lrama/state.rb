@@ -17,7 +17,7 @@ module Lrama
     # @rbs!
     #   type conflict = State::ShiftReduceConflict | State::ReduceReduceConflict
     #   type transition = Action::Shift | Action::Goto
-    #   type lookahead_set = Hash[Item, Array[Grammar::Symbol]]
+    #   type lookahead_set = Hash[Item, Bitmap::bitmap]
     #
     #   @id: Integer
     #   @accessing_symbol: Grammar::Symbol
@@ -31,8 +31,15 @@ module Lrama
     #   @nterm_transitions: Array[Action::Goto]
     #   @term_transitions: Array[Action::Shift]
     #   @transitions: Array[transition]
+    #   @transitions_by_symbol: Hash[Grammar::Symbol, transition]?
     #   @internal_dependencies: Hash[Action::Goto, Array[Action::Goto]]
+    #   @internal_dependency_lhs: Hash[Grammar::Symbol, Array[Grammar::Symbol]]?
     #   @successor_dependencies: Hash[Action::Goto, Array[Action::Goto]]
+    #   @item_lookahead_set_contributions: Hash[Integer, Array[InadequacyAnnotation::action]?]?
+    #   @items_by_next_item: Hash[Item, Item]?
+    #   @predecessors_with_item: Hash[Item, Array[[State, Item]]]
+    #   @position_zero_ancestors: Hash[Item, Array[[State, Item]]]
+    #   @annotation_index: Hash[[State, Grammar::Symbol, Array[Action::Shift | Action::Reduce]], InadequacyAnnotation]
 
     attr_reader :id #: Integer
     attr_reader :accessing_symbol #: Grammar::Symbol
@@ -53,8 +60,9 @@ module Lrama
     attr_accessor :lalr_isocore #: State
     attr_accessor :lookaheads_recomputed #: bool
     attr_accessor :follow_kernel_items #: Hash[Action::Goto, Hash[Item, bool]]
-    attr_accessor :always_follows #: Hash[Action::Goto, Array[Grammar::Symbol]]
-    attr_accessor :goto_follows #: Hash[Action::Goto, Array[Grammar::Symbol]]
+    attr_accessor :always_follows #: Hash[Action::Goto, Bitmap::bitmap]
+    attr_accessor :goto_follows #: Hash[Action::Goto, Bitmap::bitmap]
+    attr_accessor :unit_rule_bypasses #: Hash[Grammar::Symbol, [State, Integer]]
 
     # @rbs (Integer id, Grammar::Symbol accessing_symbol, Array[Item] kernels) -> void
     def initialize(id, accessing_symbol, kernels)
@@ -74,12 +82,16 @@ module Lrama
       @internal_dependencies = {}
       @successor_dependencies = {}
       @annotation_list = []
+      @annotation_index = {}
       @lookaheads_recomputed = false
       @follow_kernel_items = {}
       @always_follows = {}
       @goto_follows = {}
+      @unit_rule_bypasses = {}
       @lhs_contributions = {}
       @lane_items = {}
+      @predecessors_with_item = {}
+      @position_zero_ancestors = {}
     end
 
     # @rbs (State other) -> bool
@@ -138,15 +150,6 @@ module Lrama
       @items_to_state[items] = next_state
     end
 
-    # @rbs (Grammar::Rule rule, Array[Grammar::Symbol] look_ahead) -> void
-    def set_look_ahead(rule, look_ahead)
-      reduce = reduces.find do |r|
-        r.rule == rule
-      end
-
-      reduce.look_ahead = look_ahead
-    end
-
     # @rbs (Grammar::Rule rule, Hash[Grammar::Symbol, Array[Action::Goto]] sources) -> void
     def set_look_ahead_sources(rule, sources)
       reduce = reduces.find do |r|
@@ -197,6 +200,7 @@ module Lrama
       @transitions << new_transition
       @nterm_transitions = nil
       @term_transitions = nil
+      @transitions_by_symbol = nil
 
       @follow_kernel_items[new_transition] = @follow_kernel_items.delete(transition)
       @always_follows[new_transition] = @always_follows.delete(transition)
@@ -213,19 +217,19 @@ module Lrama
     #
     # @rbs (Grammar::Symbol sym) -> State
     def transition(sym)
-      result = nil
-
-      if sym.term?
-        result = term_transitions.find {|shift| shift.next_sym == sym }.to_state
-      else
-        result = nterm_transitions.find {|goto| goto.next_sym == sym }.to_state
-      end
+      result = find_transition(sym)&.to_state
 
       raise "Can not transit by #{sym} #{self}" if result.nil?
 
       result
     end
 
+    # @rbs (Grammar::Symbol sym) -> transition?
+    def find_transition(sym)
+      @transitions_by_symbol ||= transitions.to_h {|transition| [transition.next_sym, transition] }
+      @transitions_by_symbol[sym]
+    end
+
     # @rbs (Item item) -> Action::Reduce
     def find_reduce_by_item!(item)
       reduces.find do |r|
@@ -244,6 +248,20 @@ module Lrama
       end
     end
 
+    # Unit rule like `expr: term` which this state only reduces by
+    # without lookahead. Its action is `$$ = $1` so that the state
+    # can be bypassed as long as the destructor is shared by both symbols.
+    #
+    # @rbs () -> Grammar::Rule?
+    def eliminable_unit_rule
+      rule = default_reduction_rule
+      return nil unless rule && transitions.empty? && reduces.size == 1
+      return nil unless rule.rhs.size == 1 && rule.token_code.nil? && !rule.initial_rule?
+      return nil unless rule.lhs.destructor == rule.rhs.first.destructor
+
+      rule
+    end
+
     # @rbs () -> bool
     def has_conflicts?
       !@conflicts.empty?
@@ -303,22 +321,46 @@ module Lrama
 
     # Definition 3.43 (is_compatible)
     #
-    # @rbs (lookahead_set filtered_lookahead) -> bool
-    def is_compatible?(filtered_lookahead)
-      !lookaheads_recomputed ||
-        @lalr_isocore.annotation_list.all? {|annotation|
-          a = annotation.dominant_contribution(item_lookahead_set)
-          b = annotation.dominant_contribution(filtered_lookahead)
-          a.nil? || b.nil? || a == b
-        }
+    # `filtered_contributions` is `dominant_contributions` of the filtered
+    # lookahead set. The caller shares it among isocores.
+    #
+    # @rbs (Hash[Integer, Array[InadequacyAnnotation::action]?] filtered_contributions) -> bool
+    def is_compatible?(filtered_contributions)
+      return true unless lookaheads_recomputed
+
+      contributions = item_lookahead_set_contributions
+      @lalr_isocore.annotation_list.each_index.all? {|i|
+        a = contributions[i]
+        b = filtered_contributions[i]
+        a.nil? || b.nil? || a == b
+      }
+    end
+
+    # Dominant contributions of annotations of the LALR isocore, indexed by
+    # position in the annotation list. They are computed lazily on lookup.
+    #
+    # @rbs (lookahead_set lookaheads) -> Hash[Integer, Array[InadequacyAnnotation::action]?]
+    def dominant_contributions(lookaheads)
+      annotation_list = @lalr_isocore.annotation_list
+      Hash.new {|hash, i| hash[i] = annotation_list[i].dominant_contribution(lookaheads) }
+    end
+
+    # Cache of `dominant_contributions(item_lookahead_set)`
+    #
+    # @rbs () -> Hash[Integer, Array[InadequacyAnnotation::action]?]
+    def item_lookahead_set_contributions
+      @item_lookahead_set_contributions ||= dominant_contributions(item_lookahead_set)
     end
 
     # Definition 3.38 (lookahead_set_filters)
     #
     # @rbs () -> lookahead_set
     def lookahead_set_filters
+      # Filters depend only on the LALR isocore, so isocores share them
+      return @lalr_isocore.lookahead_set_filters if split_state?
+
       @lookahead_set_filters ||= kernels.map {|kernel|
-        [kernel, @lalr_isocore.annotation_list.select {|annotation| annotation.contributed?(kernel) }.map(&:token)]
+        [kernel, Bitmap.from_array(@lalr_isocore.annotation_list.select {|annotation| annotation.contributed?(kernel) }.map {|annotation| annotation.token.number })]
       }.to_h
     end
 
@@ -358,13 +400,14 @@ module Lrama
             [action, action.rule.empty_rule? ? lhs_contributions(action.rule.lhs, token) : kernels.map {|k| [k, k.rule == action.item.rule && k.end_of_rule?] }.to_h]
           end
         }.to_h
-        @annotation_list << InadequacyAnnotation.new(self, token, actions, contribution_matrix)
+        add_annotation(InadequacyAnnotation.new(self, token, actions, contribution_matrix))
       }
     end
 
     # Definition 3.32 (annotate_predecessor)
+    # Return true if new annotations are added to predecessor
     #
-    # @rbs (State predecessor) -> void
+    # @rbs (State predecessor) -> bool
     def annotate_predecessor(predecessor)
       propagating_list = annotation_list.map {|annotation|
         contribution_matrix = annotation.contribution_matrix.map {|action, contributions|
@@ -375,7 +418,7 @@ module Lrama
           else
             cs = predecessor.lane_items[self].map {|pred_kernel, kernel|
               c = contributions[kernel] && (
-                (kernel.position > 1 && predecessor.item_lookahead_set[pred_kernel].include?(annotation.token)) ||
+                (kernel.position > 1 && predecessor.item_lookahead_set[pred_kernel][annotation.token.number] == 1) ||
                 (kernel.position == 1 && predecessor.lhs_contributions(kernel.lhs, annotation.token)[pred_kernel])
               )
               [pred_kernel, c]
@@ -401,15 +444,30 @@ module Lrama
       @first_kernels ||= kernels.select {|kernel| kernel.position == 1 }
     end
 
-    # @rbs (Array[InadequacyAnnotation] propagating_list) -> void
+    # Merge annotations which have the same state, token and actions,
+    # then add the others.
+    # Return true if new annotations are added.
+    #
+    # @rbs (Array[InadequacyAnnotation] propagating_list) -> bool
     def append_annotation_list(propagating_list)
-      annotation_list.each do |annotation|
-        merging_list = propagating_list.select {|a| a.state == annotation.state && a.token == annotation.token && a.actions == annotation.actions }
-        annotation.merge_matrix(merging_list.map(&:contribution_matrix))
-        propagating_list -= merging_list
+      added = false
+
+      propagating_list.each do |propagating|
+        if (annotation = @annotation_index[propagating.key])
+          annotation.merge_matrix([propagating.contribution_matrix])
+        else
+          add_annotation(propagating)
+          added = true
+        end
       end
 
-      @annotation_list += propagating_list
+      added
+    end
+
+    # @rbs (InadequacyAnnotation annotation) -> void
+    def add_annotation(annotation)
+      @annotation_list << annotation
+      @annotation_index[annotation.key] = annotation
     end
 
     # Definition 3.31 (compute_lhs_contributions)
@@ -421,10 +479,10 @@ module Lrama
       transition = nterm_transitions.find {|goto| goto.next_sym == sym }
       @lhs_contributions[sym] ||= {}
       @lhs_contributions[sym][token] =
-        if always_follows[transition].include?(token)
+        if always_follows[transition][token.number] == 1
           {}
         else
-          kernels.map {|kernel| [kernel, follow_kernel_items[transition][kernel] && item_lookahead_set[kernel].include?(token)] }.to_h
+          kernels.map {|kernel| [kernel, follow_kernel_items[transition][kernel] && item_lookahead_set[kernel][token.number] == 1] }.to_h
         end
     end
 
@@ -434,14 +492,14 @@ module Lrama
     def item_lookahead_set
       return @item_lookahead_set if @item_lookahead_set
 
-      @item_lookahead_set = kernels.map {|k| [k, []] }.to_h
+      @item_lookahead_set = kernels.map {|k| [k, 0] }.to_h
       @item_lookahead_set = kernels.map {|kernel|
         value =
           if kernel.lhs.accept_symbol?
-            []
+            0
           elsif kernel.position > 1
             prev_items = predecessors_with_item(kernel)
-            prev_items.map {|st, i| st.item_lookahead_set[i] }.reduce([]) {|acc, syms| acc |= syms }
+            prev_items.map {|st, i| st.item_lookahead_set[i] }.reduce(0) {|acc, bitmap| acc | bitmap }
           elsif kernel.position == 1
             prev_state = @predecessors.find {|p| p.transitions.any? {|transition| transition.next_sym == kernel.lhs } }
             goto = prev_state.nterm_transitions.find {|goto| goto.next_sym == kernel.lhs }
@@ -454,36 +512,56 @@ module Lrama
     # @rbs (lookahead_set k) -> void
     def item_lookahead_set=(k)
       @item_lookahead_set = k
+      @item_lookahead_set_contributions = nil
     end
 
+    # Reverse edges of the item graph. Return pairs of a predecessor state
+    # and its item which is `item` before the transition.
+    #
     # @rbs (Item item) -> Array[[State, Item]]
     def predecessors_with_item(item)
-      result = []
-      @predecessors.each do |pre|
-        pre.items.each do |i|
-          result << [pre, i] if i.predecessor_item_of?(item)
-        end
-      end
-      result
+      @predecessors_with_item[item] ||= @predecessors.filter_map {|pre|
+        i = pre.items_by_next_item[item]
+        [pre, i] if i
+      }
+    end
+
+    # Items indexed by the item after their transition
+    #
+    # @rbs () -> Hash[Item, Item]
+    def items_by_next_item
+      @items_by_next_item ||= @items.reject(&:end_of_rule?).to_h {|i| [i.new_by_next_position, i] }
+    end
+
+    # Items at position 0 which reach `item` by following predecessors.
+    # Chains shared by items are traversed only once.
+    #
+    # @rbs (Item item) -> Array[[State, Item]]
+    def position_zero_ancestors(item)
+      return [[self, item]] if item.position == 0
+
+      @position_zero_ancestors[item] ||= predecessors_with_item(item).flat_map {|st, i| st.position_zero_ancestors(i) }.uniq
     end
 
     # @rbs (State prev_state) -> void
     def append_predecessor(prev_state)
       @predecessors << prev_state
       @predecessors.uniq!
+      @predecessors_with_item.clear
+      @position_zero_ancestors.clear
     end
 
     # Definition 3.39 (compute_goto_follow_set)
     #
-    # @rbs (Grammar::Symbol nterm_token) -> Array[Grammar::Symbol]
+    # @rbs (Grammar::Symbol nterm_token) -> Bitmap::bitmap
     def goto_follow_set(nterm_token)
-      return [] if nterm_token.accept_symbol?
+      return 0 if nterm_token.accept_symbol?
       goto = @lalr_isocore.nterm_transitions.find {|g| g.next_sym == nterm_token }
 
       @kernels
         .select {|kernel| @lalr_isocore.follow_kernel_items[goto][kernel] }
         .map {|kernel| item_lookahead_set[kernel] }
-        .reduce(@lalr_isocore.always_follows[goto]) {|result, terms| result |= terms }
+        .reduce(@lalr_isocore.always_follows[goto]) {|result, bitmap| result | bitmap }
     end
 
     # Definition 3.8 (Goto Follows Internal Relation)
@@ -492,9 +570,12 @@ module Lrama
     def internal_dependencies(goto)
       return @internal_dependencies[goto] if @internal_dependencies[goto]
 
-      syms = @items.select {|i|
-        i.next_sym == goto.next_sym && i.symbols_after_transition.all?(&:nullable) && i.position == 0
-      }.map(&:lhs).uniq
+      # Scan items once for all gotos of this state
+      @internal_dependency_lhs ||= @items.each_with_object({}) {|i, h|
+        next unless i.position == 0 && !i.end_of_rule? && i.symbols_after_transition.all?(&:nullable)
+        (h[i.next_sym] ||= []) << i.lhs
+      }
+      syms = @internal_dependency_lhs.fetch(goto.next_sym, []).uniq
       @internal_dependencies[goto] = nterm_transitions.select {|goto2| syms.include?(goto2.next_sym) }
     end
 
@@ -511,22 +592,11 @@ module Lrama
     #
     # @rbs (Action::Goto goto) -> Array[Action::Goto]
     def predecessor_dependencies(goto)
-      state_items = []
-      @kernels.select {|kernel|
+      state_items = @kernels.select {|kernel|
         kernel.next_sym == goto.next_sym && kernel.symbols_after_transition.all?(&:nullable)
-      }.each do |item|
-        queue = predecessors_with_item(item)
-        until queue.empty?
-          st, i = queue.pop
-          if i.position == 0
-            state_items << [st, i]
-          else
-            st.predecessors_with_item(i).each {|v| queue << v }
-          end
-        end
-      end
+      }.flat_map {|item| predecessors_with_item(item).flat_map {|st, i| st.position_zero_ancestors(i) } }
 
-      state_items.map {|state, item|
+      state_items.uniq.map {|state, item|
         state.nterm_transitions.find {|goto2| goto2.next_sym == item.lhs }
       }
     end
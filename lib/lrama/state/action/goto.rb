@@ -14,11 +14,13 @@ module Lrama
         #   @next_sym: Grammar::Symbol
         #   @to_items: Array[Item]
         #   @to_state: State
+        #   @id: Integer
 
         attr_reader :from_state #: State
         attr_reader :next_sym #: Grammar::Symbol
         attr_reader :to_items #: Array[Item]
         attr_reader :to_state #: State
+        attr_accessor :id #: Integer
 
         # @rbs (State from_state, Grammar::Symbol next_sym, Array[Item] to_items, State to_state) -> void
         def initialize(from_state, next_sym, to_items, to_state)
@@ -12,11 +12,13 @@ module Lrama
         # @rbs!
         #   @item: Item
         #   @look_ahead: Array[Grammar::Symbol]?
+        #   @look_ahead_bitmap: Bitset?
+        #   @symbols: Array[Grammar::Symbol]
         #   @look_ahead_sources: Hash[Grammar::Symbol, Array[Action::Goto]]?
         #   @not_selected_symbols: Array[Grammar::Symbol]
 
         attr_reader :item #: Item
-        attr_reader :look_ahead #: Array[Grammar::Symbol]?
+        attr_reader :look_ahead_bitmap #: Bitset?
         attr_reader :look_ahead_sources #: Hash[Grammar::Symbol, Array[Action::Goto]]?
         attr_reader :not_selected_symbols #: Array[Grammar::Symbol]
 
@@ -27,6 +29,8 @@ module Lrama
         def initialize(item)
           @item = item
           @look_ahead = nil
+          @look_ahead_bitmap = nil
+          @symbols = []
           @look_ahead_sources = nil
           @not_selected_symbols = []
         end
@@ -36,9 +40,22 @@ module Lrama
           @item.rule
         end
 
-        # @rbs (Array[Grammar::Symbol] look_ahead) -> Array[Grammar::Symbol]
-        def look_ahead=(look_ahead)
-          @look_ahead = look_ahead.freeze
+        # Look-ahead is kept as a bitmap of term numbers.
+        # `symbols` is used to convert it to Symbols when `look_ahead` is called.
+        #
+        # @rbs (Bitset look_ahead_bitmap, Array[Grammar::Symbol] symbols) -> void
+        def set_look_ahead_bitmap(look_ahead_bitmap, symbols)
+          @look_ahead_bitmap = look_ahead_bitmap
+          @symbols = symbols
+          @look_ahead = nil
+        end
+
+        # @rbs () -> Array[Grammar::Symbol]?
+        def look_ahead
+          return @look_ahead if @look_ahead
+          return nil unless @look_ahead_bitmap
+
+          @look_ahead = @look_ahead_bitmap.map {|i| @symbols[i] }.freeze
         end
 
         # @rbs (Hash[Grammar::Symbol, Array[Action::Goto]] sources) -> Hash[Grammar::Symbol, Array[Action::Goto]]
@@ -51,6 +68,16 @@ module Lrama
           @not_selected_symbols << sym
         end
 
+        # Whether any look-ahead is left after conflict resolution.
+        # Symbols in `not_selected_symbols` are always included in look-ahead.
+        #
+        # @rbs () -> bool
+        def selected_look_ahead?
+          return false unless @look_ahead_bitmap
+
+          @look_ahead_bitmap.count > @not_selected_symbols.count
+        end
+
         # @rbs () -> (::Array[Grammar::Symbol?])
         def selected_look_ahead
           if look_ahead
@@ -20,6 +20,13 @@ module Lrama
         @contribution_matrix = contribution_matrix
       end
 
+      # Annotations with the same key are merged
+      #
+      # @rbs () -> [State, Grammar::Symbol, Array[action]]
+      def key
+        [@state, @token, @actions]
+      end
+
       # @rbs (Item item) -> bool
       def contributed?(item)
         @contribution_matrix.any? {|action, contributions| !contributions.nil? && contributions[item] }
@@ -42,7 +49,7 @@ module Lrama
       # @rbs (State::lookahead_set lookaheads) -> Array[action]?
       def dominant_contribution(lookaheads)
         actions = @actions.select {|action|
-          contribution_matrix[action].nil? || contribution_matrix[action].any? {|item, contributed| contributed && lookaheads[item].include?(@token) }
+          contribution_matrix[action].nil? || contribution_matrix[action].any? {|item, contributed| contributed && lookaheads[item][@token.number] == 1 }
         }
         return nil if actions.empty?
 
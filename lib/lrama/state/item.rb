@@ -24,7 +24,7 @@ module Lrama
       #
       # @rbs () -> Integer
       def hash
-        [rule_id, position].hash
+        @hash ||= [rule_id, position].hash
       end
 
       # @rbs () -> Integer
@@ -72,9 +72,11 @@ module Lrama
         rule.initial_rule? && beginning_of_rule?
       end
 
+      # Memoized so that items derived from shared items are shared too
+      #
       # @rbs () -> State::Item
       def new_by_next_position
-        Item.new(rule: rule, position: position + 1)
+        @new_by_next_position ||= Item.new(rule: rule, position: position + 1)
       end
 
       # @rbs () -> Array[Grammar::Symbol]
@@ -18,93 +18,114 @@ module Lrama
     # @rbs!
     #   type state_id = Integer
     #   type rule_id = Integer
+    #   type goto_id = Integer
     #
     #   include Grammar::_DelegatedMethods
     #
     #   @grammar: Grammar
     #   @tracer: Tracer
+    #   @jobs: Integer
     #   @states: Array[State]
-    #   @direct_read_sets: Hash[State::Action::Goto, Bitmap::bitmap]
-    #   @reads_relation: Hash[State::Action::Goto, Array[State::Action::Goto]]
-    #   @read_sets: Hash[State::Action::Goto, Bitmap::bitmap]
-    #   @includes_relation: Hash[State::Action::Goto, Array[State::Action::Goto]]
-    #   @lookback_relation: Hash[state_id, Hash[rule_id, Array[State::Action::Goto]]]
-    #   @follow_sets: Hash[State::Action::Goto, Bitmap::bitmap]
-    #   @la: Hash[state_id, Hash[rule_id, Bitmap::bitmap]]
+    #   @nterm_transitions: Array[State::Action::Goto]
+    #   @direct_read_sets: Array[Bitset]
+    #   @reads_relation: Array[Array[goto_id]?]
+    #   @read_sets: Array[Bitset]
+    #   @includes_relation: Array[Array[goto_id]?]
+    #   @lookback_relation: Array[Hash[rule_id, Array[goto_id]]?]
+    #   @follow_sets: Array[Bitset]
+    #   @la: Array[Hash[rule_id, Bitset]?]
+    #   @transition_paths: Array[Hash[rule_id, Array[State]]?]
+    #   @position_zero_items: Array[State::Item]
+    #   @item_offsets: Array[Integer]
+    #   @closure_templates: Array[Bitset]
 
     extend Forwardable
     include Lrama::Tracer::Duration
 
+    # Frontiers of LR(0) states are computed by workers only if
+    # each worker gets at least this number of states
+    LR0_MIN_CHUNK_SIZE = 64 #: Integer
+
     def_delegators "@grammar", :symbols, :terms, :nterms, :rules, :precedences,
-      :accept_symbol, :eof_symbol, :undef_symbol, :find_symbol_by_s_value!, :ielr_defined?
+      :accept_symbol, :eof_symbol, :error_symbol, :undef_symbol, :find_symbol_by_s_value!, :ielr_defined?
 
     attr_reader :states #: Array[State]
-    attr_reader :reads_relation #: Hash[State::Action::Goto, Array[State::Action::Goto]]
-    attr_reader :includes_relation #: Hash[State::Action::Goto, Array[State::Action::Goto]]
-    attr_reader :lookback_relation #: Hash[state_id, Hash[rule_id, Array[State::Action::Goto]]]
 
-    # @rbs (Grammar grammar, Tracer tracer) -> void
-    def initialize(grammar, tracer)
+    # @rbs (Grammar grammar, Tracer tracer, ?jobs: Integer) -> void
+    def initialize(grammar, tracer, jobs: 1)
       @grammar = grammar
       @tracer = tracer
+      # Number of worker processes used to compute look-ahead relations
+      @jobs = jobs
 
       @states = []
 
+      # All nonterminal transitions (gotos) of the automaton.
+      # A goto is identified by its index in this array (`goto.id`),
+      # relations and sets below are arrays indexed by the goto id.
+      @nterm_transitions = []
+
       # `DR(p, A) = {t ∈ T | p -(A)-> r -(t)-> }`
       #   where p is state, A is nterm, t is term.
       #
-      # `@direct_read_sets` is a hash whose
-      # key is goto,
+      # `@direct_read_sets` is an array whose
+      # index is goto id,
       # value is bitmap of term.
-      @direct_read_sets = {}
+      @direct_read_sets = []
 
       # Reads relation on nonterminal transitions (pair of state and nterm)
       # `(p, A) reads (r, C) iff p -(A)-> r -(C)-> and C =>* ε`
       #   where p, r are state, A, C are nterm.
       #
-      # `@reads_relation` is a hash whose
-      # key is goto,
-      # value is array of goto.
-      @reads_relation = {}
+      # `@reads_relation` is an array whose
+      # index is goto id,
+      # value is array of goto id.
+      @reads_relation = []
 
       # `Read(p, A) =s DR(p, A) ∪ ∪{Read(r, C) | (p, A) reads (r, C)}`
       #
-      # `@read_sets` is a hash whose
-      # key is goto,
+      # `@read_sets` is an array whose
+      # index is goto id,
       # value is bitmap of term.
-      @read_sets = {}
+      @read_sets = []
 
       # `(p, A) includes (p', B) iff B -> βAγ, γ =>* ε, p' -(β)-> p`
       #   where p, p' are state, A, B are nterm, β, γ is sequence of symbol.
       #
-      # `@includes_relation` is a hash whose
-      # key is goto,
-      # value is array of goto.
-      @includes_relation = {}
+      # `@includes_relation` is an array whose
+      # index is goto id,
+      # value is array of goto id.
+      @includes_relation = []
 
       # `(q, A -> ω) lookback (p, A) iff p -(ω)-> q`
       #   where p, q are state, A -> ω is rule, A is nterm, ω is sequence of symbol.
       #
-      # `@lookback_relation` is a two-stage hash whose
-      # first key is state_id,
-      # second key is rule_id,
-      # value is array of goto.
-      @lookback_relation = {}
+      # `@lookback_relation` is an array of hash whose
+      # index is state_id,
+      # key is rule_id,
+      # value is array of goto id.
+      @lookback_relation = []
 
       # `Follow(p, A) =s Read(p, A) ∪ ∪{Follow(p', B) | (p, A) includes (p', B)}`
       #
-      # `@follow_sets` is a hash whose
-      # key is goto,
+      # `@follow_sets` is an array whose
+      # index is goto id,
       # value is bitmap of term.
-      @follow_sets = {}
+      @follow_sets = []
 
       # `LA(q, A -> ω) = ∪{Follow(p, A) | (q, A -> ω) lookback (p, A)`
       #
-      # `@la` is a two-stage hash whose
-      # first key is state_id,
-      # second key is rule_id,
+      # `@la` is an array of hash whose
+      # index is state_id,
+      # key is rule_id,
       # value is bitmap of term.
-      @la = {}
+      @la = []
+
+      # `@transition_paths` is an array of hash whose
+      # index is state_id,
+      # key is rule_id,
+      # value is states on the way of transitions by rule.rhs.
+      @transition_paths = []
     end
 
     # @rbs () -> void
@@ -141,6 +162,33 @@ module Lrama
       report_duration(:compute_default_reduction) { compute_default_reduction }
     end
 
+    # Bypass states which only reduce by a unit rule without action, e.g. `expr: term`.
+    # A transition into such state goes to the goto target of the rule lhs directly,
+    # following chains of unit rules like `expr: term` and `term: factor`.
+    #
+    # @rbs () -> void
+    def compute_unit_rule_elimination
+      # Hooks are called for each reduction
+      return if @grammar.before_reduce || @grammar.after_reduce
+
+      report_duration(:compute_unit_rule_elimination) do
+        @states.each do |state|
+          state.transitions.each do |transition|
+            to_state = transition.to_state
+            count = 0
+
+            # Count guards cycles of unit rules
+            while (rule = to_state.eliminable_unit_rule) && count < @states.count
+              to_state = state.transition(rule.lhs)
+              count += 1
+            end
+
+            state.unit_rule_bypasses[transition.next_sym] = [to_state, count] if count > 0
+          end
+        end
+      end
+    end
+
     # @rbs () -> Integer
     def states_count
       @states.count
@@ -148,29 +196,46 @@ module Lrama
 
     # @rbs () -> Hash[State::Action::Goto, Array[Grammar::Symbol]]
     def direct_read_sets
-      @_direct_read_sets ||= @direct_read_sets.transform_values do |v|
-        bitmap_to_terms(v)
-      end
+      @_direct_read_sets ||= gotos_to_terms(@direct_read_sets)
+    end
+
+    # @rbs () -> Hash[State::Action::Goto, Array[State::Action::Goto]]
+    def reads_relation
+      @_reads_relation ||= gotos_to_gotos(@reads_relation)
     end
 
     # @rbs () -> Hash[State::Action::Goto, Array[Grammar::Symbol]]
     def read_sets
-      @_read_sets ||= @read_sets.transform_values do |v|
-        bitmap_to_terms(v)
+      @_read_sets ||= gotos_to_terms(@read_sets)
+    end
+
+    # @rbs () -> Hash[State::Action::Goto, Array[State::Action::Goto]]
+    def includes_relation
+      @_includes_relation ||= gotos_to_gotos(@includes_relation)
+    end
+
+    # @rbs () -> Hash[state_id, Hash[rule_id, Array[State::Action::Goto]]]
+    def lookback_relation
+      @_lookback_relation ||= @lookback_relation.each_with_index.each_with_object({}) do |(second_hash, state_id), hash|
+        next unless second_hash
+
+        hash[state_id] = second_hash.transform_values do |ids|
+          ids.map {|id| @nterm_transitions[id] }
+        end
       end
     end
 
     # @rbs () -> Hash[State::Action::Goto, Array[Grammar::Symbol]]
     def follow_sets
-      @_follow_sets ||= @follow_sets.transform_values do |v|
-        bitmap_to_terms(v)
-      end
+      @_follow_sets ||= gotos_to_terms(@follow_sets)
     end
 
     # @rbs () -> Hash[state_id, Hash[rule_id, Array[Grammar::Symbol]]]
     def la
-      @_la ||= @la.transform_values do |second_hash|
-        second_hash.transform_values do |v|
+      @_la ||= @la.each_with_index.each_with_object({}) do |(second_hash, state_id), hash|
+        next unless second_hash
+
+        hash[state_id] = second_hash.transform_values do |v|
           bitmap_to_terms(v)
         end
       end
@@ -192,17 +257,12 @@ module Lrama
     end
 
     def compute_la_sources_for_conflicted_states
-      reflexive = {}
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          reflexive[goto] = [goto]
-        end
-      end
+      reflexive = @nterm_transitions.map {|goto| [goto.id] }
 
       # compute_read_sets
-      read_sets = Digraph.new(nterm_transitions, @reads_relation, reflexive).compute
+      read_sets = compute_goto_digraph(@reads_relation, reflexive)
       # compute_follow_sets
-      follow_sets = Digraph.new(nterm_transitions, @includes_relation, read_sets).compute
+      follow_sets = compute_goto_digraph(@includes_relation, read_sets)
 
       @states.select(&:has_conflicts?).each do |state|
         lookback_relation_on_state = @lookback_relation[state.id]
@@ -213,12 +273,13 @@ module Lrama
 
           sources = {}
 
-          ary.each do |goto|
-            source = follow_sets[goto]
+          ary.each do |goto_id|
+            source = follow_sets[goto_id]
 
             next unless source
 
-            source.each do |goto2|
+            source.each do |goto2_id|
+              goto2 = @nterm_transitions[goto2_id]
               tokens = direct_read_sets[goto2]
               tokens.each do |token|
                 sources[token] ||= []
@@ -234,7 +295,7 @@ module Lrama
 
     private
 
-    # @rbs (Grammar::Symbol accessing_symbol, Array[State::Item] kernels, Hash[Array[State::Item], State] states_created) -> [State, bool]
+    # @rbs (Grammar::Symbol accessing_symbol, Array[State::Item] kernels, Hash[Array[Integer], State] states_created) -> [State, bool]
     def create_state(accessing_symbol, kernels, states_created)
       # A item can appear in some states,
       # so need to use `kernels` (not `kernels.first`) as a key.
@@ -272,45 +333,101 @@ module Lrama
       #    string_1: string •
       #    string_2: string • '+'
       #
-      return [states_created[kernels], false] if states_created[kernels]
+      signature = kernel_signature(kernels)
+      return [states_created[signature], false] if states_created[signature]
 
       state = State.new(@states.count, accessing_symbol, kernels)
       @states << state
-      states_created[kernels] = state
+      states_created[signature] = state
 
       return [state, true]
     end
 
-    # @rbs (State state) -> void
-    def setup_state(state)
-      # closure
-      closure = []
-      queued = {}
-      items = state.kernels.dup
+    # @rbs (State state, ?Bitset rule_ids) -> void
+    def setup_state(state, rule_ids = closure_rule_ids(state))
+      # Items are ordered by rule id
+      state.closure = rule_ids.map {|rule_id| @position_zero_items[rule_id] }
+
+      # Trace
+      @tracer.trace_closure(state)
+
+      # shift & reduce
+      state.compute_transitions_and_reduces
+    end
+
+    # Rule ids of closure items of state
+    #
+    # @rbs (State state) -> Bitset
+    def closure_rule_ids(state)
+      rule_ids = Bitset.new(rules.count)
+
+      state.kernels.each do |item|
+        sym = item.next_sym
+        next unless sym&.nterm?
 
-      items.each do |item|
-        queued[item.rule_id] = true if item.position == 0
+        rule_ids.or!(@closure_templates[sym.number - terms.count])
       end
 
-      while (item = items.shift) do
-        if (sym = item.next_sym) && sym.nterm?
-          @grammar.find_rules_by_symbol!(sym).each do |rule|
-            next if queued[rule.id]
-            i = State::Item.new(rule: rule, position: 0)
-            closure << i
-            items << i
-            queued[i.rule_id] = true
-          end
-        end
+      # Kernel items at position 0 are not included in closure
+      state.kernels.each do |item|
+        rule_ids.unset(item.rule_id) if item.position == 0
       end
 
-      state.closure = closure.sort_by {|i| i.rule.id }
+      rule_ids
+    end
 
-      # Trace
-      @tracer.trace_closure(state)
+    # Intern items so that items of the same rule and position are shared
+    # by all states. Items at position 0 are created here and the others
+    # by `State::Item#new_by_next_position`, which is memoized.
+    # An item is identified by a small integer, `@item_offsets[rule.id] + position`.
+    #
+    # @rbs () -> void
+    def intern_items
+      @position_zero_items = []
+      @item_offsets = []
+      offset = 0
+
+      rules.each do |rule|
+        @position_zero_items[rule.id] = State::Item.new(rule: rule, position: 0)
+        @item_offsets[rule.id] = offset
+        offset += rule.rhs.count + 1
+      end
+    end
 
-      # shift & reduce
-      state.compute_transitions_and_reduces
+    # Kernels are compared by item ids instead of items,
+    # so that looking up states doesn't hash and compare items.
+    #
+    # @rbs (Array[State::Item] kernels) -> Array[Integer]
+    def kernel_signature(kernels)
+      kernels.map {|item| @item_offsets[item.rule_id] + item.position }
+    end
+
+    # Precompute closure of each nterm as a bitmap of rule ids.
+    # The closure of nterm A includes rules of A and closures of nterms
+    # which are the left corner (rhs[0]) of rules of A.
+    #
+    # @rbs () -> void
+    def compute_closure_templates
+      # Index of these arrays is `nterm.number - terms.count`
+      relation = [] #: Array[Array[Integer]?]
+      base_function = [] #: Array[Bitset]
+
+      nterms.each do |nterm|
+        index = nterm.number - terms.count
+        bitset = Bitset.new(rules.count)
+
+        @grammar.find_rules_by_symbol!(nterm).each do |rule|
+          bitset.set(rule.id)
+          sym = rule.rhs.first
+          next unless sym&.nterm?
+
+          (relation[index] ||= []) << sym.number - terms.count
+        end
+
+        base_function[index] = bitset
+      end
+
+      @closure_templates = IndexedDigraph.new(nterms.count, relation, base_function).compute
     end
 
     # @rbs (Array[State] states, State state) -> void
@@ -327,24 +444,39 @@ module Lrama
       states = []
       states_created = {}
 
-      state, _ = create_state(symbols.first, [State::Item.new(rule: @grammar.rules.first, position: 0)], states_created)
-      enqueue_state(states, state)
-
-      while (state = states.shift) do
-        # Trace
-        @tracer.trace_state(state)
+      intern_items
+      compute_closure_templates
 
-        setup_state(state)
+      state, _ = create_state(symbols.first, [@position_zero_items[@grammar.rules.first.id]], states_created)
+      enqueue_state(states, state)
 
-        # `State#transitions` can not be used here
-        # because `items_to_state` of the `state` is not set yet.
-        state._transitions.each do |next_sym, to_items|
-          new_state, created = create_state(next_sym, to_items, states_created)
-          state.set_items_to_state(to_items, new_state)
-          state.set_lane_items(next_sym, new_state)
-          enqueue_state(states, new_state) if created
+      # States are processed by BFS frontier. Closures of a frontier don't
+      # depend on each other so that they are computed by workers with `jobs` > 1.
+      # Then states of the frontier are set up and their successors are
+      # created in the queue order, so state ids are the same as the serial mode.
+      until states.empty?
+        frontier = states
+        states = []
+        closures = parallel_map(frontier, min_chunk_size: LR0_MIN_CHUNK_SIZE) {|s| closure_rule_ids(s) }
+
+        frontier.each_with_index do |state, i|
+          # Trace
+          @tracer.trace_state(state)
+
+          setup_state(state, closures[i])
+
+          # `State#transitions` can not be used here
+          # because `items_to_state` of the `state` is not set yet.
+          state._transitions.each do |next_sym, to_items|
+            new_state, created = create_state(next_sym, to_items, states_created)
+            state.set_items_to_state(to_items, new_state)
+            state.set_lane_items(next_sym, new_state)
+            enqueue_state(states, new_state) if created
+          end
         end
       end
+
+      index_nterm_transitions
     end
 
     # @rbs () -> Array[State::Action::Goto]
@@ -360,6 +492,45 @@ module Lrama
       a
     end
 
+    # Give every goto a dense integer id so that look-ahead relations
+    # and sets can be stored in arrays instead of hashes keyed by gotos.
+    #
+    # @rbs () -> void
+    def index_nterm_transitions
+      @nterm_transitions = nterm_transitions
+      @nterm_transitions.each_with_index do |goto, i|
+        goto.id = i
+      end
+    end
+
+    # Run Digraph over gotos by their ids.
+    #
+    # @rbs [Y] (Array[Array[goto_id]?] relation, Array[Y] base_function) -> Array[Y]
+    def compute_goto_digraph(relation, base_function)
+      IndexedDigraph.new(@nterm_transitions.count, relation, base_function).compute
+    end
+
+    # @rbs (Array[Bitset] sets) -> Hash[State::Action::Goto, Array[Grammar::Symbol]]
+    def gotos_to_terms(sets)
+      @nterm_transitions.to_h do |goto|
+        [goto, bitmap_to_terms(sets[goto.id])]
+      end
+    end
+
+    # @rbs (Array[Array[goto_id]?] relation) -> Hash[State::Action::Goto, Array[State::Action::Goto]]
+    def gotos_to_gotos(relation)
+      hash = {}
+
+      @nterm_transitions.each do |goto|
+        ids = relation[goto.id]
+        next unless ids
+
+        hash[goto] = ids.map {|id| @nterm_transitions[id] }
+      end
+
+      hash
+    end
+
     # @rbs () -> void
     def compute_look_ahead_sets
       report_duration(:compute_direct_read_sets) { compute_direct_read_sets }
@@ -373,96 +544,189 @@ module Lrama
 
     # @rbs () -> void
     def compute_direct_read_sets
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          ary = goto.to_state.term_transitions.map do |shift|
-            shift.next_sym.number
-          end
+      size = terms.count
+
+      @direct_read_sets = parallel_map(@nterm_transitions) do |goto|
+        bitset = Bitset.new(size)
 
-          @direct_read_sets[goto] = Bitmap.from_array(ary)
+        goto.to_state.term_transitions.each do |shift|
+          bitset.set(shift.next_sym.number)
         end
+
+        bitset
       end
     end
 
     # @rbs () -> void
     def compute_reads_relation
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          goto.to_state.nterm_transitions.each do |goto2|
-            nterm2 = goto2.next_sym
-            if nterm2.nullable
-              @reads_relation[goto] ||= []
-              @reads_relation[goto] << goto2
-            end
-          end
-        end
+      relations = parallel_map(@nterm_transitions) do |goto|
+        goto.to_state.nterm_transitions.select {|goto2| goto2.next_sym.nullable }.map(&:id)
+      end
+
+      relations.each_with_index do |goto_ids, goto_id|
+        @reads_relation[goto_id] = goto_ids unless goto_ids.empty?
       end
     end
 
     # @rbs () -> void
     def compute_read_sets
-      @read_sets = Digraph.new(nterm_transitions, @reads_relation, @direct_read_sets).compute
+      @read_sets = compute_goto_digraph(@reads_relation, @direct_read_sets)
     end
 
-    # Execute transition of state by symbols
-    # then return final state.
+    # Execute transitions of state by symbols of rule.rhs
+    # then return all states on the way.
+    # `path[i]` is the state reached by `rule.rhs[0...i]`,
+    # so `path[0]` is state itself and `path.last` is the state reducing rule.
     #
-    # @rbs (State state, Array[Grammar::Symbol] symbols) -> State
-    def transition(state, symbols)
-      symbols.each do |sym|
-        state = state.transition(sym)
-      end
+    # Paths are memoized because both includes and lookback relations
+    # walk the same (state, rule) pairs.
+    #
+    # @rbs (State state, Grammar::Rule rule) -> Array[State]
+    def transition_path(state, rule)
+      paths = (@transition_paths[state.id] ||= {})
+
+      paths[rule.id] ||= begin
+        path = [state]
 
-      state
+        rule.rhs.each do |sym|
+          state = state.transition(sym)
+          path << state
+        end
+
+        path
+      end
     end
 
     # @rbs () -> void
     def compute_includes_relation
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          nterm = goto.next_sym
-          @grammar.find_rules_by_symbol!(nterm).each do |rule|
-            i = rule.rhs.count - 1
-
-            while (i > -1) do
-              sym = rule.rhs[i]
-
-              break if sym.term?
-              state2 = transition(state, rule.rhs[0...i])
-              # p' = state, B = nterm, p = state2, A = sym
-              key = state2.nterm_transitions.find do |goto2|
-                goto2.next_sym.token_id == sym.token_id
-              end || (raise "Goto by #{sym.name} on state #{state2.id} is not found")
-              # TODO: need to omit if state == state2 ?
-              @includes_relation[key] ||= []
-              @includes_relation[key] << goto
-              break unless sym.nullable
-              i -= 1
-            end
+      # Ids of gotos which include each goto
+      relations = parallel_map(@nterm_transitions) do |goto|
+        state = goto.from_state
+        nterm = goto.next_sym
+        key_ids = [] #: Array[goto_id]
+
+        @grammar.find_rules_by_symbol!(nterm).each do |rule|
+          path = transition_path(state, rule)
+          i = rule.rhs.count - 1
+
+          while (i > -1) do
+            sym = rule.rhs[i]
+
+            break if sym.term?
+            state2 = path[i]
+            # p' = state, B = nterm, p = state2, A = sym
+            key = state2.find_transition(sym) || (raise "Goto by #{sym.name} on state #{state2.id} is not found")
+            # TODO: need to omit if state == state2 ?
+            key_ids << key.id
+            break unless sym.nullable
+            i -= 1
           end
         end
+
+        key_ids
+      end
+
+      relations.each_with_index do |key_ids, goto_id|
+        key_ids.each do |key_id|
+          @includes_relation[key_id] ||= []
+          @includes_relation[key_id] << goto_id
+        end
       end
     end
 
     # @rbs () -> void
     def compute_lookback_relation
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          nterm = goto.next_sym
-          @grammar.find_rules_by_symbol!(nterm).each do |rule|
-            state2 = transition(state, rule.rhs)
-            # p = state, A = nterm, q = state2, A -> ω = rule
-            @lookback_relation[state2.id] ||= {}
-            @lookback_relation[state2.id][rule.id] ||= []
-            @lookback_relation[state2.id][rule.id] << goto
-          end
+      # Pairs of state id and rule id which look back each goto
+      relations = parallel_map(@nterm_transitions) do |goto|
+        state = goto.from_state
+        nterm = goto.next_sym
+
+        @grammar.find_rules_by_symbol!(nterm).map do |rule|
+          state2 = transition_path(state, rule).last
+          # p = state, A = nterm, q = state2, A -> ω = rule
+          [state2.id, rule.id]
+        end
+      end
+
+      relations.each_with_index do |pairs, goto_id|
+        pairs.each do |state_id, rule_id|
+          @lookback_relation[state_id] ||= {}
+          @lookback_relation[state_id][rule_id] ||= []
+          @lookback_relation[state_id][rule_id] << goto_id
+        end
+      end
+    end
+
+    # Map items with the block.
+    #
+    # With `jobs` > 1, items are split into contiguous chunks and each chunk
+    # is mapped by a forked worker process. Workers read the automaton as it
+    # was at fork time and send their results back with Marshal, so the block
+    # must return plain data such as ids and bitsets, not states.
+    # Results are joined in chunk order, so they are the same as the serial mode.
+    # An exception raised by the block in a worker is sent back and re-raised.
+    # Items are mapped serially if a chunk would be smaller than `min_chunk_size`.
+    #
+    # @rbs [T, U] (Array[T] items, ?min_chunk_size: Integer) { (T) -> U } -> Array[U]
+    def parallel_map(items, min_chunk_size: 1, &block)
+      jobs = [@jobs, items.count / min_chunk_size].min
+      return items.map(&block) if jobs <= 1 || !Process.respond_to?(:fork)
+
+      chunk_size = (items.count + jobs - 1) / jobs
+      workers = items.each_slice(chunk_size).map do |chunk|
+        reader, writer = IO.pipe
+        pid = fork do
+          reader.close
+          result =
+            begin
+              [:ok, chunk.map(&block)]
+            rescue Exception => e # rubocop:disable Lint/RescueException
+              [:error, e]
+            end
+          writer.write(dump_worker_result(result))
+          writer.close
+          exit!(0)
+        rescue Exception # rubocop:disable Lint/RescueException
+          exit!(1)
         end
+        writer.close
+        [pid, reader]
+      end
+
+      results = workers.map do |pid, reader|
+        data = reader.read
+        reader.close
+        _, status = Process.wait2(pid)
+        [status, data]
       end
+
+      results.flat_map do |status, data|
+        raise "Worker process #{status.pid} failed" unless status.success?
+        tag, value = Marshal.load(data)
+        raise value if tag == :error
+        value
+      end
+    end
+
+    # Dump the result of a worker. An exception which can not be dumped, e.g.
+    # the one referring to a Proc, is replaced with a RuntimeError carrying
+    # the original class, message and backtrace.
+    #
+    # @rbs ([Symbol, untyped] result) -> String
+    def dump_worker_result(result)
+      Marshal.dump(result)
+    rescue TypeError
+      tag, e = result
+      raise unless tag == :error
+
+      error = RuntimeError.new("#{e.class}: #{e.message}")
+      error.set_backtrace(e.backtrace)
+      Marshal.dump([tag, error])
     end
 
     # @rbs () -> void
     def compute_follow_sets
-      @follow_sets = Digraph.new(nterm_transitions, @includes_relation, @read_sets).compute
+      @follow_sets = compute_goto_digraph(@includes_relation, @read_sets)
     end
 
     # @rbs () -> void
@@ -470,36 +734,37 @@ module Lrama
       @states.each do |state|
         lookback_relation_on_state = @lookback_relation[state.id]
         next unless lookback_relation_on_state
-        rules.each do |rule|
-          ary = lookback_relation_on_state[rule.id]
+
+        # Only reduce items can have lookback relation,
+        # so it's enough to check reduces of the state instead of all rules.
+        state.reduces.each do |reduce|
+          ary = lookback_relation_on_state[reduce.rule.id]
           next unless ary
 
-          ary.each do |goto|
+          look_ahead = Bitset.new(terms.count)
+          ary.each do |goto_id|
             # q = state, A -> ω = rule, p = state2, A = nterm
-            follows = @follow_sets[goto]
+            look_ahead.or!(@follow_sets[goto_id])
+          end
 
-            next if follows == 0
+          next if look_ahead.empty?
 
-            @la[state.id] ||= {}
-            @la[state.id][rule.id] ||= 0
-            look_ahead = @la[state.id][rule.id] | follows
-            @la[state.id][rule.id] |= look_ahead
+          @la[state.id] ||= {}
+          @la[state.id][reduce.rule.id] = look_ahead
 
-            # No risk of conflict when
-            # * the state only has single reduce
-            # * the state only has nterm_transitions (GOTO)
-            next if state.reduces.count == 1 && state.term_transitions.count == 0
+          # No risk of conflict when
+          # * the state only has single reduce
+          # * the state only has nterm_transitions (GOTO)
+          next if state.reduces.count == 1 && state.term_transitions.count == 0
 
-            state.set_look_ahead(rule, bitmap_to_terms(look_ahead))
-          end
+          reduce.set_look_ahead_bitmap(look_ahead, @grammar.symbols)
         end
       end
     end
 
-    # @rbs (Bitmap::bitmap bit) -> Array[Grammar::Symbol]
+    # @rbs (Bitset bit) -> Array[Grammar::Symbol]
     def bitmap_to_terms(bit)
-      ary = Bitmap.to_array(bit)
-      ary.map do |i|
+      bit.map do |i|
         @grammar.find_symbol_by_number!(i)
       end
     end
@@ -513,12 +778,24 @@ module Lrama
     # @rbs () -> void
     def compute_shift_reduce_conflicts(lr_type)
       states.each do |state|
+        next if state.term_transitions.empty?
+
+        shift_bitmap = Bitset.new(terms.count)
+        state.term_transitions.each do |shift|
+          shift_bitmap.set(shift.next_sym.number)
+        end
+
+        # Only reduces whose look-ahead overlaps shifts can conflict
+        reduces = state.reduces.select do |reduce|
+          reduce.look_ahead_bitmap&.intersect?(shift_bitmap)
+        end
+        next if reduces.empty?
+
         state.term_transitions.each do |shift|
-          state.reduces.each do |reduce|
+          reduces.each do |reduce|
             sym = shift.next_sym
 
-            next unless reduce.look_ahead
-            next unless reduce.look_ahead.include?(sym)
+            next unless reduce.look_ahead_bitmap.include?(sym.number) # steep:ignore NoMethod
 
             # Shift/Reduce conflict
             shift_prec = sym.precedence
@@ -608,13 +885,13 @@ module Lrama
     def compute_reduce_reduce_conflicts
       states.each do |state|
         state.reduces.combination(2) do |reduce1, reduce2|
-          next if reduce1.look_ahead.nil? || reduce2.look_ahead.nil?
+          look_ahead1 = reduce1.look_ahead_bitmap
+          look_ahead2 = reduce2.look_ahead_bitmap
+          next if look_ahead1.nil? || look_ahead2.nil?
+          next unless look_ahead1.intersect?(look_ahead2)
 
-          intersection = reduce1.look_ahead & reduce2.look_ahead
-
-          unless intersection.empty?
-            state.conflicts << State::ReduceReduceConflict.new(symbols: intersection, reduce1: reduce1, reduce2: reduce2)
-          end
+          intersection = bitmap_to_terms(look_ahead1 & look_ahead2)
+          state.conflicts << State::ReduceReduceConflict.new(symbols: intersection, reduce1: reduce1, reduce2: reduce2)
         end
       end
     end
@@ -629,7 +906,7 @@ module Lrama
         next if state.term_transitions.map {|shift| shift.next_sym }.include?(@grammar.error_symbol)
 
         state.default_reduction_rule = state.reduces.map do |r|
-          [r.rule, r.rule.id, (r.look_ahead || []).count]
+          [r.rule, r.rule.id, r.look_ahead_bitmap&.count || 0]
         end.min_by do |rule, rule_id, count|
           [-count, rule_id]
         end.first
@@ -656,10 +933,10 @@ module Lrama
     #
     # @rbs () -> void
     def compute_follow_kernel_items
-      set = nterm_transitions
       relation = compute_goto_internal_relation
       base_function = compute_goto_bitmaps
-      Digraph.new(set, relation, base_function).compute.each do |goto, follow_kernel_items|
+      compute_goto_digraph(relation, base_function).each_with_index do |follow_kernel_items, goto_id|
+        goto = @nterm_transitions[goto_id]
         state = goto.from_state
         state.follow_kernel_items[goto] = state.kernels.map {|kernel|
           [kernel, Bitmap.to_bool_array(follow_kernel_items, state.kernels.count)]
@@ -667,89 +944,73 @@ module Lrama
       end
     end
 
-    # @rbs () -> Hash[State::Action::Goto, Array[State::Action::Goto]]
+    # @rbs () -> Array[Array[goto_id]]
     def compute_goto_internal_relation
-      relations = {}
-
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          relations[goto] = state.internal_dependencies(goto)
-        end
+      @nterm_transitions.map do |goto|
+        goto.from_state.internal_dependencies(goto).map(&:id)
       end
-
-      relations
     end
 
-    # @rbs () -> Hash[State::Action::Goto, Bitmap::bitmap]
+    # @rbs () -> Array[Bitmap::bitmap]
     def compute_goto_bitmaps
-      nterm_transitions.map {|goto|
+      @nterm_transitions.map {|goto|
         bools = goto.from_state.kernels.map.with_index {|kernel, i| i if kernel.next_sym == goto.next_sym && kernel.symbols_after_transition.all?(&:nullable) }.compact
-        [goto, Bitmap.from_array(bools)]
-      }.to_h
+        Bitmap.from_array(bools)
+      }
     end
 
     # Definition 3.20 (always_follows, one closure)
     #
     # @rbs () -> void
     def compute_always_follows
-      set = nterm_transitions
       relation = compute_goto_successor_or_internal_relation
       base_function = compute_transition_bitmaps
-      Digraph.new(set, relation, base_function).compute.each do |goto, always_follows_bitmap|
-        goto.from_state.always_follows[goto] = bitmap_to_terms(always_follows_bitmap)
+      compute_goto_digraph(relation, base_function).each_with_index do |always_follows_bitmap, goto_id|
+        goto = @nterm_transitions[goto_id]
+        goto.from_state.always_follows[goto] = always_follows_bitmap
       end
     end
 
-    # @rbs () -> Hash[State::Action::Goto, Array[State::Action::Goto]]
+    # @rbs () -> Array[Array[goto_id]]
     def compute_goto_successor_or_internal_relation
-      relations = {}
-
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          relations[goto] = state.successor_dependencies(goto) + state.internal_dependencies(goto)
-        end
+      @nterm_transitions.map do |goto|
+        state = goto.from_state
+        (state.successor_dependencies(goto) + state.internal_dependencies(goto)).map(&:id)
       end
-
-      relations
     end
 
-    # @rbs () -> Hash[State::Action::Goto, Bitmap::bitmap]
+    # @rbs () -> Array[Bitmap::bitmap]
     def compute_transition_bitmaps
-      nterm_transitions.map {|goto|
-        [goto, Bitmap.from_array(goto.to_state.term_transitions.map {|shift| shift.next_sym.number })]
-      }.to_h
+      @nterm_transitions.map {|goto|
+        Bitmap.from_array(goto.to_state.term_transitions.map {|shift| shift.next_sym.number })
+      }
     end
 
     # Definition 3.24 (goto_follows, via always_follows)
     #
     # @rbs () -> void
     def compute_goto_follows
-      set = nterm_transitions
       relation = compute_goto_internal_or_predecessor_dependencies
       base_function = compute_always_follows_bitmaps
-      Digraph.new(set, relation, base_function).compute.each do |goto, goto_follows_bitmap|
-        goto.from_state.goto_follows[goto] = bitmap_to_terms(goto_follows_bitmap)
+      compute_goto_digraph(relation, base_function).each_with_index do |goto_follows_bitmap, goto_id|
+        goto = @nterm_transitions[goto_id]
+        goto.from_state.goto_follows[goto] = goto_follows_bitmap
       end
     end
 
-    # @rbs () -> Hash[State::Action::Goto, Array[State::Action::Goto]]
+    # @rbs () -> Array[Array[goto_id]]
     def compute_goto_internal_or_predecessor_dependencies
-      relations = {}
-
-      @states.each do |state|
-        state.nterm_transitions.each do |goto|
-          relations[goto] = state.internal_dependencies(goto) + state.predecessor_dependencies(goto)
-        end
+      @nterm_transitions.map do |goto|
+        state = goto.from_state
+        (state.internal_dependencies(goto) + state.predecessor_dependencies(goto)).map(&:id)
       end
-
-      relations
     end
 
-    # @rbs () -> Hash[State::Action::Goto, Bitmap::bitmap]
+    # @rbs () -> Array[Bitmap::bitmap]
     def compute_always_follows_bitmaps
-      nterm_transitions.map {|goto|
-        [goto, Bitmap.from_array(goto.from_state.always_follows[goto].map(&:number))]
-      }.to_h
+      @nterm_transitions.map {|goto|
+        goto.from_state.always_follows[goto]
+      }
     end
 
     # @rbs () -> void
@@ -759,6 +1020,9 @@ module Lrama
           compute_state(state, transition, transition.to_state)
         end
       end
+
+      # Splitting adds new states and replaces gotos, so ids need to be reassigned
+      index_nterm_transitions
     end
 
     # @rbs () -> void
@@ -768,31 +1032,66 @@ module Lrama
       end
 
       queue = @states.reject {|state| state.annotation_list.empty? }
+      # Bitmap of ids of states in queue
+      queued = Bitset.new(@states.count)
+      queue.each {|state| queued.set(state.id) }
 
       while (curr = queue.shift) do
+        queued.unset(curr.id)
+
         curr.predecessors.each do |pred|
-          cache = pred.annotation_list.dup
-          curr.annotate_predecessor(pred)
-          queue << pred if cache != pred.annotation_list && !queue.include?(pred)
+          next unless curr.annotate_predecessor(pred)
+          next if queued[pred.id]
+
+          queue << pred
+          queued.set(pred.id)
         end
       end
     end
 
-    # @rbs (State state, State::lookahead_set filtered_lookaheads) -> void
+    # Return true if lookaheads of state are changed
+    #
+    # @rbs (State state, State::lookahead_set filtered_lookaheads) -> bool
     def merge_lookaheads(state, filtered_lookaheads)
-      return if state.kernels.all? {|item| (filtered_lookaheads[item] - state.item_lookahead_set[item]).empty? }
+      return false if state.kernels.all? {|item| filtered_lookaheads[item] & ~state.item_lookahead_set[item] == 0 }
 
       state.item_lookahead_set = state.item_lookahead_set.merge {|_, v1, v2| v1 | v2 }
-      state.transitions.each do |transition|
-        next if transition.to_state.lookaheads_recomputed
-        compute_state(state, transition, transition.to_state)
-      end
+      true
     end
 
+    # When lookaheads of a state are merged, they are propagated to
+    # its successors again. This is done with an explicit stack instead
+    # of recursion so that deep automata don't exhaust the Ruby stack.
+    # Frames are processed in the same order as the recursion would do.
+    #
     # @rbs (State state, State::Action::Shift | State::Action::Goto transition, State next_state) -> void
     def compute_state(state, transition, next_state)
+      # Each frame is a state whose lookaheads are merged, index of the next transition to visit,
+      # and the transition which is updated after all successors are visited.
+      stack = [] #: Array[[State, Integer, State, State::Action::Shift | State::Action::Goto]]
+      compute_state_step(state, transition, next_state, stack)
+
+      while (frame = stack.last) do
+        s, i, prev_state, prev_transition = frame
+        t = s.transitions[i]
+
+        if t.nil?
+          stack.pop
+          prev_state.update_transition(prev_transition, s) if prev_state.items_to_state[prev_transition.to_items].id != s.id
+          next
+        end
+
+        frame[1] = i + 1
+        next if t.to_state.lookaheads_recomputed
+        compute_state_step(s, t, t.to_state, stack)
+      end
+    end
+
+    # @rbs (State state, State::Action::Shift | State::Action::Goto transition, State next_state, Array[[State, Integer, State, State::Action::Shift | State::Action::Goto]] stack) -> void
+    def compute_state_step(state, transition, next_state, stack)
       propagating_lookaheads = state.propagate_lookaheads(next_state)
-      s = next_state.ielr_isocores.find {|st| st.is_compatible?(propagating_lookaheads) }
+      contributions = next_state.dominant_contributions(propagating_lookaheads)
+      s = next_state.ielr_isocores.find {|st| st.is_compatible?(contributions) }
 
       if s.nil?
         s = next_state.lalr_isocore
@@ -814,8 +1113,10 @@ module Lrama
       elsif(!s.lookaheads_recomputed)
         s.lookaheads_recomputed = true
         s.item_lookahead_set = propagating_lookaheads
+      elsif merge_lookaheads(s, propagating_lookaheads)
+        # Visit successors of s, then update the transition
+        stack << [s, 0, state, transition]
       else
-        merge_lookaheads(s, propagating_lookaheads)
         state.update_transition(transition, s) if state.items_to_state[transition.to_items].id != s.id
       end
     end
@@ -857,9 +1158,13 @@ module Lrama
       @lookback_relation.clear
       @follow_sets.clear
       @la.clear
+      @transition_paths.clear
 
       @_direct_read_sets = nil
+      @_reads_relation = nil
       @_read_sets = nil
+      @_includes_relation = nil
+      @_lookback_relation = nil
       @_follow_sets = nil
       @_la = nil
     end
@@ -0,0 +1,109 @@
+/*
+ * Integration test for %define api.location.type compact
+ * The lexer tracks byte offsets, and the offsets of @$ are mapped back
+ * to lines and columns with yyline_index_lookup.
+ */
+
+%{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "compact_location.h"
+
+static const char *text = "";
+static long pos = 0;
+static yyline_index *lines = NULL;
+
+static int yylex(YYSTYPE *val, YYLTYPE *loc);
+static int yyerror(YYLTYPE *loc, const char *str);
+static void print_location(const char *what, const YYLTYPE *loc);
+%}
+
+%define api.pure
+%locations
+%define api.location.type compact
+
+%token NUMBER
+
+%left '+'
+
+%%
+
+program: /* empty */
+       | program line
+       ;
+
+line: expr ';'  { printf("%d ", $1); print_location("expr", &@1); }
+    | error ';' { print_location("error", &@1); print_location("line", &@$); yyerrok; }
+    ;
+
+expr: NUMBER
+    | expr '+' expr { $$ = $1 + $3; }
+    | '(' expr ')'  { $$ = $2; }
+    ;
+
+%%
+
+static int yylex(YYSTYPE *val, YYLTYPE *loc)
+{
+  while (text[pos] == ' ' || text[pos] == '\n') {
+    pos++;
+  }
+
+  loc->begin_offset = (int) pos;
+  if (!text[pos]) {
+    loc->end_offset = (int) pos;
+    return YYEOF;
+  }
+  if ('0' <= text[pos] && text[pos] <= '9') {
+    char *end;
+    *val = (int) strtol(text + pos, &end, 10);
+    pos = end - text;
+    loc->end_offset = (int) pos;
+    return NUMBER;
+  }
+  pos++;
+  loc->end_offset = (int) pos;
+  return text[pos - 1];
+}
+
+static int yyerror(YYLTYPE *loc, const char *str)
+{
+  print_location(str, loc);
+  return 0;
+}
+
+/* Print the offsets of LOC and the lines and columns they map to.  */
+static void print_location(const char *what, const YYLTYPE *loc)
+{
+  int begin_line, begin_column, end_line, end_column;
+
+  yyline_index_lookup(lines, loc->begin_offset, &begin_line, &begin_column);
+  yyline_index_lookup(lines, loc->end_offset, &end_line, &end_column);
+  printf("%s: %d-%d (%d.%d-%d.%d)\n", what, loc->begin_offset, loc->end_offset,
+         begin_line, begin_column, end_line, end_column);
+}
+
+int main(int argc, char *argv[])
+{
+  long length;
+  int line, column;
+  int status;
+
+  if (argc == 2) {
+    text = argv[1];
+  }
+  length = (long) strlen(text);
+  lines = yyline_index_new(text, length);
+
+  status = yyparse();
+  printf("status=%d\n", status);
+
+  /* The end of the text is a valid position, past it is not.  */
+  status = yyline_index_lookup(lines, length, &line, &column);
+  printf("offset %ld: %d (%d.%d)\n", length, status, line, column);
+  printf("offset %ld: %d\n", length + 1, yyline_index_lookup(lines, length + 1, &line, &column));
+
+  yyline_index_delete(lines);
+  return 0;
+}
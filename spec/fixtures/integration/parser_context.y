@@ -0,0 +1,94 @@
+/*
+ * Integration test for %define api.parser-context
+ * One context is reused for parses growing its stacks past YYINITDEPTH,
+ * hitting its maximum depth, and succeeding again afterwards.
+ */
+
+%{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "parser_context.h"
+
+static const char *input = "";
+static int yylex(YYSTYPE *val);
+static int yyerror(YYLTYPE *loc, const char *str);
+%}
+
+%define api.pure
+%define api.parser-context
+
+%token NUMBER
+
+%left '+'
+%left '*'
+
+%%
+
+program: expr { printf("=> %d\n", $1); }
+       ;
+
+expr: NUMBER
+    | expr '+' expr { $$ = $1 + $3; }
+    | expr '*' expr { $$ = $1 * $3; }
+    | '(' expr ')'  { $$ = $2; }
+    ;
+
+%%
+
+static int yylex(YYSTYPE *val)
+{
+  while (*input == ' ') {
+    input++;
+  }
+
+  if (!*input) {
+    return YYEOF;
+  }
+  if ('0' <= *input && *input <= '9') {
+    *val = (int) strtol(input, (char **) &input, 10);
+    return NUMBER;
+  }
+  return *input++;
+}
+
+static int yyerror(YYLTYPE *loc, const char *str)
+{
+  (void) loc;
+  printf("%s\n", str);
+  return 0;
+}
+
+/* Parse DEPTH nested parentheses around 1.  */
+static int parse_nested(yyparse_context *ctx, int depth)
+{
+  char *text = (char *) malloc(2 * depth + 2);
+  int status;
+
+  memset(text, '(', depth);
+  text[depth] = '1';
+  memset(text + depth + 1, ')', depth);
+  text[2 * depth + 1] = '\0';
+  input = text;
+  status = yyparse_context_parse(ctx);
+  free(text);
+  return status;
+}
+
+int main(int argc, char *argv[])
+{
+  yyparse_context *ctx = yyparse_context_new(0, 500);
+
+  input = argc == 2 ? argv[1] : "";
+  printf("status=%d\n", yyparse_context_parse(ctx));
+
+  /* Grow the stacks past YYINITDEPTH, then hit the maximum depth.  */
+  printf("status=%d\n", parse_nested(ctx, 300));
+  printf("status=%d\n", parse_nested(ctx, 600));
+
+  input = "2 * (3 + 4)";
+  printf("status=%d\n", yyparse_context_parse(ctx));
+
+  yyparse_context_delete(ctx);
+  return 0;
+}
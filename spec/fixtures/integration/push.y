@@ -0,0 +1,123 @@
+/*
+ * Integration test for %define api.push-pull push
+ * Tokens are pushed one by one, two parses are interleaved on separate
+ * pstates, and the pstates are reused after their parses finish.
+ */
+
+%{
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "push.h"
+
+static int yyerror(YYLTYPE *loc, const char *name, const char *str);
+%}
+
+%define api.pure
+%define api.push-pull push
+%parse-param {const char *name}
+
+%token NUMBER
+
+%left '+'
+%left '*'
+
+%%
+
+program: expr { printf("%s => %d\n", name, $1); }
+       ;
+
+expr: NUMBER
+    | expr '+' expr { $$ = $1 + $3; }
+    | expr '*' expr { $$ = $1 * $3; }
+    | '(' expr ')'  { $$ = $2; }
+    ;
+
+%%
+
+static int yyerror(YYLTYPE *loc, const char *name, const char *str)
+{
+  (void) loc;
+  printf("%s: %s\n", name, str);
+  return 0;
+}
+
+/* Push the next token of *input and count the pushes asking for more.  */
+static int push_next(yypstate *ps, const char *name, const char **input, int *more)
+{
+  YYSTYPE val = 0;
+  int token;
+  int status;
+
+  while (**input == ' ') {
+    (*input)++;
+  }
+
+  if (!**input) {
+    token = YYEOF;
+  } else if ('0' <= **input && **input <= '9') {
+    val = (int) strtol(*input, (char **) input, 10);
+    token = NUMBER;
+  } else {
+    token = *(*input)++;
+  }
+
+  status = yypush_parse(ps, token, &val, NULL, name);
+  if (status == YYPUSH_MORE) {
+    (*more)++;
+  }
+  return status;
+}
+
+static void parse(yypstate *ps, const char *name, const char *input)
+{
+  int more = 0;
+  int status;
+
+  do {
+    status = push_next(ps, name, &input, &more);
+  } while (status == YYPUSH_MORE);
+  printf("%s: status=%d more=%d\n", name, status, more);
+}
+
+int main(int argc, char *argv[])
+{
+  const char *a = argc == 2 ? argv[1] : "";
+  const char *b = "(4 + 5) * 6";
+  int a_status = YYPUSH_MORE, b_status = YYPUSH_MORE;
+  int a_more = 0, b_more = 0;
+  yypstate *ps1 = yypstate_new();
+  yypstate *ps2 = yypstate_new();
+  char *deep;
+  int depth = 300;
+
+  /* Interleave two parses, one token at a time.  */
+  while (a_status == YYPUSH_MORE || b_status == YYPUSH_MORE) {
+    if (a_status == YYPUSH_MORE) {
+      a_status = push_next(ps1, "a", &a, &a_more);
+    }
+    if (b_status == YYPUSH_MORE) {
+      b_status = push_next(ps2, "b", &b, &b_more);
+    }
+  }
+  printf("a: status=%d more=%d\n", a_status, a_more);
+  printf("b: status=%d more=%d\n", b_status, b_more);
+
+  /* Reuse the finished pstates, growing the stack past YYINITDEPTH
+     and recovering from an aborted parse.  */
+  deep = (char *) malloc(2 * depth + 2);
+  memset(deep, '(', depth);
+  deep[depth] = '1';
+  memset(deep + depth + 1, ')', depth);
+  deep[2 * depth + 1] = '\0';
+  parse(ps1, "deep", deep);
+  free(deep);
+
+  parse(ps2, "error", "1 + * 2");
+  parse(ps2, "c", "2 * 3");
+  parse(ps1, "d", "1 + 2 * 3");
+
+  yypstate_delete(ps1);
+  yypstate_delete(ps2);
+  return 0;
+}
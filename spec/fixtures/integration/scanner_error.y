@@ -0,0 +1,54 @@
+/*
+ * Integration test for a scanner returning YYerror without %locations
+ * The parser enters error recovery directly, without reporting
+ * an extra syntax error.
+ */
+
+%{
+#include <stdio.h>
+#include "scanner_error.h"
+#include "scanner_error-lexer.h"
+
+static int nerr = 0;
+static int yyerror(YYLTYPE *loc, const char *str);
+%}
+
+%token NUMBER
+
+%%
+
+lines: /* empty */
+     | lines line
+     ;
+
+line: expr '\n'  { printf("%d\n", $1); }
+    | error '\n' { printf("recovered\n"); yyerrok; }
+    ;
+
+expr: NUMBER
+    | expr '+' NUMBER { $$ = $1 + $3; }
+    ;
+
+%%
+
+static int yyerror(YYLTYPE *loc, const char *str)
+{
+  (void) loc;
+  nerr++;
+  fprintf(stderr, "%s\n", str);
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc == 2) {
+    yy_scan_string(argv[1]);
+  }
+
+  if (yyparse()) {
+    fprintf(stderr, "syntax error\n");
+    return 1;
+  }
+  printf("nerr=%d\n", nerr);
+  return 0;
+}
@@ -0,0 +1,65 @@
+# frozen_string_literal: true
+
+RSpec.describe Lrama::Bitset do
+  describe "#set and #include?" do
+    it "holds bits across words" do
+      bitset = Lrama::Bitset.new(200)
+      bitset.set(0).set(61).set(62).set(199)
+
+      expect(bitset.to_a).to eq([0, 61, 62, 199])
+      expect(bitset.include?(62)).to be(true)
+      expect(bitset.include?(63)).to be(false)
+      expect(bitset.include?(200)).to be(false)
+      expect(bitset.count).to eq(4)
+      expect(bitset.to_i).to eq((1 << 0) | (1 << 61) | (1 << 62) | (1 << 199))
+
+      bitset.unset(62)
+      expect(bitset.to_a).to eq([0, 61, 199])
+    end
+  end
+
+  describe "#or!" do
+    it "merges other into self in place" do
+      a = Lrama::Bitset.from_array(100, [1, 70])
+      b = Lrama::Bitset.from_array(100, [2, 70, 99])
+
+      expect(a.or!(b)).to equal(a)
+      expect(a.to_a).to eq([1, 2, 70, 99])
+      expect(b.to_a).to eq([2, 70, 99])
+    end
+  end
+
+  describe "set operations" do
+    it "returns the same result as Integer bitmaps" do
+      random = Random.new(42)
+
+      20.times do
+        size = random.rand(1..300)
+        ary1 = Array.new(random.rand(0..20)) { random.rand(size) }
+        ary2 = Array.new(random.rand(0..20)) { random.rand(size) }
+        a = Lrama::Bitset.from_array(size, ary1)
+        b = Lrama::Bitset.from_array(size, ary2)
+        x = Lrama::Bitmap.from_array(ary1)
+        y = Lrama::Bitmap.from_array(ary2)
+
+        expect((a | b).to_i).to eq(x | y)
+        expect((a & b).to_i).to eq(x & y)
+        expect((a - b).to_i).to eq(x & ~y)
+        expect(a.intersect?(b)).to eq(x & y != 0)
+        expect(a.subset?(b)).to eq(x & y == x)
+        expect(a.to_a).to eq(Lrama::Bitmap.to_array(x))
+      end
+    end
+  end
+
+  describe "#eql? and #hash" do
+    it "can be used as a Hash key" do
+      a = Lrama::Bitset.from_array(100, [3, 80])
+      b = Lrama::Bitset.from_array(100, [80, 3])
+      hash = { a => 1 }
+
+      expect(hash[b]).to eq(1)
+      expect(hash[Lrama::Bitset.from_array(100, [3])]).to be_nil
+    end
+  end
+end
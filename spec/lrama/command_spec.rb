@@ -71,6 +71,20 @@ RSpec.describe Lrama::Command do
       end
     end
 
+    context "when `-e` option and lr.unit-rule-elimination are specified" do
+      it "does not bypass unit rules" do
+        grammar_file = fixture_path("integration/error_recovery.y")
+        outputs = [[], %w[-Dlr.unit-rule-elimination], %w[-e], %w[-e -Dlr.unit-rule-elimination]].map do |args|
+          Lrama::Command.new(o_option + args + [grammar_file]).run
+          File.read(outfile)
+        end
+
+        # `expr: NUM` is bypassed without `-e`
+        expect(outputs[1]).not_to eq(outputs[0])
+        expect(outputs[3]).to eq(outputs[2])
+      end
+    end
+
     context "when `--report-file` option specified" do
       it "create report file" do
         allow(File).to receive(:open).and_call_original
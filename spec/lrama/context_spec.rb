@@ -150,6 +150,176 @@ RSpec.describe Lrama::Context do
     end
   end
 
+  describe "compute_packed_table" do
+    let(:states) do
+      y = <<~INPUT
+        %token NUM ID
+        %left '+' '-'
+        %left '*' '/'
+        %right '^'
+
+        %%
+
+        program: stmts ;
+
+        stmts: stmt
+             | stmts ';' stmt
+             ;
+
+        stmt: ID '=' expr
+            | expr
+            | '{' stmts '}'
+            | /* empty */
+            ;
+
+        expr: NUM
+            | ID
+            | expr '+' expr
+            | expr '-' expr
+            | expr '*' expr
+            | expr '/' expr
+            | expr '^' expr
+            | '-' expr
+            | '(' expr ')'
+            | ID '(' args ')'
+            ;
+
+        args: /* empty */
+            | expr
+            | args ',' expr
+            ;
+
+        %%
+      INPUT
+
+      grammar = Lrama::Parser.new(y, "parse.y").parse
+      grammar.prepare
+      grammar.validate!
+      states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new))
+      states.compute
+      states
+    end
+
+    # Action of each vector on each symbol
+    def decode(context)
+      (context.yypact + context.yypgoto).map do |base|
+        (0...context.states.states.count).map do |x|
+          i = base + x
+          context.yytable[i] if i >= 0 && i <= context.yylast && context.yycheck[i] == x
+        end
+      end
+    end
+
+    it "packs vectors which share the table" do
+      context = Lrama::Context.new(states)
+
+      # Same tables as the first-fit search which advances one slot at a time
+      expect(context.yypact).to eq([
+         0,    -6,    17,     7,     0,     7,     1,    -5,    -6,    29,
+         7,     7,     6,    37,    30,    18,    -6,     0,     7,     7,
+         7,     7,     7,    29,    29,    14,    -6,    -6,    -6,    37,
+        37,    13,    13,    13,    -6,     7,    29
+      ])
+      expect(context.yypgoto).to eq([
+        -6,    -6,     5,    22,    -3,    -6
+      ])
+      expect(context.yytable).to eq([
+        13,    16,    15,     1,     2,    17,     3,    23,    24,    14,
+         1,    12,     4,     3,     5,    29,    30,    31,    32,    33,
+        11,     5,    22,    18,    19,    20,    21,    22,    10,    34,
+        35,    11,    36,    27,    18,    19,    20,    21,    22,    28,
+        17,     0,     0,    26,    20,    21,    22
+      ])
+      expect(context.yycheck).to eq([
+         3,     0,     5,     3,     4,    10,     6,    10,    11,     4,
+         3,     4,    12,     6,    14,    18,    19,    20,    21,    22,
+        14,    14,     9,     5,     6,     7,     8,     9,    11,    15,
+        16,    14,    35,    15,     5,     6,     7,     8,     9,    17,
+        10,    -1,    -1,    13,     7,     8,     9
+      ])
+    end
+
+    it "makes the table smaller with table_compression: :max" do
+      context = Lrama::Context.new(states)
+      compressed = Lrama::Context.new(states, table_compression: :max)
+
+      expect(context.yylast).to eq(46)
+      expect(compressed.yylast).to eq(44)
+      expect(compressed.yytable.count).to eq(compressed.yylast + 1)
+      expect(decode(compressed)).to eq(decode(context))
+    end
+
+    it "expands packed tables into yydense_action and yydense_goto" do
+      context = Lrama::Context.new(states)
+      actions = decode(context)
+      state_count = context.states.states.count
+
+      dense_action = (0...state_count).flat_map do |state|
+        (0...context.yyntokens).map do |token|
+          context.yypact[state] == context.yypact_ninf ? 0 : (actions[state][token] || 0)
+        end
+      end
+      dense_goto = (0...state_count).flat_map do |state|
+        (0...context.yynnts).map do |nterm|
+          actions[state_count + nterm][state] || context.yydefgoto[nterm]
+        end
+      end
+
+      expect(context.yydense_action.count).to eq(state_count * context.yyntokens)
+      expect(context.yydense_action).to eq(dense_action)
+      expect(context.yydense_goto.count).to eq(state_count * context.yynnts)
+      expect(context.yydense_goto).to eq(dense_goto)
+    end
+  end
+
+  describe "compute_repair_dist" do
+    let(:states) do
+      y = <<~INPUT
+        %token NUM
+        %left '+'
+
+        %%
+
+        program: expr ;
+
+        expr: NUM
+            | expr '+' expr
+            | '(' expr ')'
+            ;
+
+        %%
+      INPUT
+
+      grammar = Lrama::Parser.new(y, "parse.y").parse
+      grammar.prepare
+      grammar.validate!
+      states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new))
+      states.compute
+      states
+    end
+
+    it "computes the number of tokens to be inserted before each token is shifted" do
+      context = Lrama::Context.new(states)
+      dist = ->(state) do
+        row = context.yyrepair_dist_row[state]
+        context.yyrepair_dist[row * context.yyntokens, context.yyntokens]
+      end
+      max = Lrama::Context::RepairDistMax
+
+      # Tokens are "end of file", error, "invalid token", NUM, '+', '(' and ')'
+      # State 0: $accept -> • program "end of file"
+      expect(dist.call(0)).to eq([1, max, max, 0, 1, 0, 1])
+      # State 1: expr -> NUM •
+      expect(dist.call(1)).to eq([0, max, max, 1, 0, 1, 0])
+      # State 3: $accept -> program • "end of file"
+      expect(dist.call(3).first).to eq(0)
+      # State 7: expr -> expr '+' • expr
+      expect(dist.call(7)).to eq(dist.call(0))
+      expect(context.yyrepair_dist_row[7]).to eq(context.yyrepair_dist_row[0])
+      expect(context.yyrepair_dist.count).to eq(context.yyrepair_dist_row.max * context.yyntokens + context.yyntokens)
+    end
+  end
+
   describe "compute_yydefact" do
     describe "S/R conflicts are resolved to reduce" do
       it "does not include shift into actions" do
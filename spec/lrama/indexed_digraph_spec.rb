@@ -0,0 +1,48 @@
+# frozen_string_literal: true
+
+RSpec.describe Lrama::IndexedDigraph do
+  describe "#compute" do
+    it "propagates attributes along edges and shares them within a SCC" do
+      # 0 -> 1 -> 2 -> 1, 2 -> 3
+      relation = [[1], [2], [1, 3], nil]
+      base_function = [0b0001, 0b0010, 0b0100, 0b1000]
+      result = Lrama::IndexedDigraph.new(4, relation, base_function).compute
+
+      expect(result).to eq([0b1111, 0b1110, 0b1110, 0b1000])
+      expect(result[1]).to equal(result[2])
+    end
+
+    it "returns the same result as Digraph" do
+      random = Random.new(42)
+
+      20.times do
+        size = random.rand(1..60)
+        relation = Array.new(size) { Array.new(random.rand(0..3)) { random.rand(size) } }
+        base_function = Array.new(size) { random.rand(1 << 16) }
+
+        expected = Lrama::Digraph.new((0...size).to_a, relation, base_function).compute
+        result = Lrama::IndexedDigraph.new(size, relation, base_function).compute
+
+        expect(result).to eq(expected.values_at(*0...size))
+      end
+    end
+
+    it "merges Bitset attributes in place without modifying base_function" do
+      relation = [[1], [2], [1, 3], nil]
+      base_function = [[0], [1], [2], [3]].map {|ary| Lrama::Bitset.from_array(4, ary) }
+      result = Lrama::IndexedDigraph.new(4, relation, base_function).compute
+
+      expect(result.map(&:to_a)).to eq([[0, 1, 2, 3], [1, 2, 3], [1, 2, 3], [3]])
+      expect(base_function.map(&:to_a)).to eq([[0], [1], [2], [3]])
+    end
+
+    it "does not overflow the stack on a deep graph" do
+      size = 100_000
+      relation = Array.new(size) {|i| i + 1 < size ? [i + 1] : nil }
+      base_function = Array.new(size) {|i| i == size - 1 ? 1 : 0 }
+      result = Lrama::IndexedDigraph.new(size, relation, base_function).compute
+
+      expect(result.all? {|v| v == 1 }).to be(true)
+    end
+  end
+end
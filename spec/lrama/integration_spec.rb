@@ -45,8 +45,13 @@ RSpec.describe "integration" do
 
       unless IntegrationHelper.compiled_parsers[cache_key] && File.exist?(obj_path)
         Lrama::Command.new(%W[-H#{parser_h_path} -o#{parser_c_path}] + lrama_command_args + %W[#{grammar_file_path}]).run
-        exec_command("flex --header-file=#{lexer_h_path} -o #{lexer_c_path} #{lexer_file_path}")
-        exec_command("#{compiler} -Wall -O0 -g -I#{tmpdir} #{parser_c_path} #{lexer_c_path} -o #{obj_path}")
+        # Fixtures driving the parser by themselves have no lexer
+        if File.exist?(lexer_file_path)
+          exec_command("flex --header-file=#{lexer_h_path} -o #{lexer_c_path} #{lexer_file_path}")
+          exec_command("#{compiler} -Wall -O0 -g -I#{tmpdir} #{parser_c_path} #{lexer_c_path} -o #{obj_path}")
+        else
+          exec_command("#{compiler} -Wall -O0 -g -I#{tmpdir} #{parser_c_path} -o #{obj_path}")
+        end
         IntegrationHelper.compiled_parsers[cache_key] = true
       end
 
@@ -86,12 +91,108 @@ RSpec.describe "integration" do
     end
   end
 
+  describe "calculator with api.tables dense" do
+    it "returns 9 for '(1+2)*3'" do
+      test_parser("calculator", "( 1 + 2 ) * 3", "=> 9", lrama_command_args: %W[-Dapi.tables=dense])
+    end
+  end
+
+  describe "calculator with yacc-direct.c skeleton" do
+    it "returns 9 for '(1+2)*3'" do
+      test_parser("calculator", "( 1 + 2 ) * 3", "=> 9", lrama_command_args: %W[-Sbison/yacc-direct.c])
+    end
+  end
+
+  describe "calculator with lr.unit-rule-elimination" do
+    it "returns 9 for '(1+2)*3'" do
+      test_parser("calculator", "( 1 + 2 ) * 3", "=> 9", lrama_command_args: %W[-Dlr.unit-rule-elimination])
+    end
+  end
+
+  describe "calculator with api.push-pull both" do
+    it "returns 9 for '(1+2)*3'" do
+      test_parser("calculator", "( 1 + 2 ) * 3", "=> 9", lrama_command_args: %W[-Dapi.push-pull=both])
+    end
+  end
+
+  describe "api.push-pull push" do
+    it "parses pushed tokens on interleaved and reused pstates" do
+      expected = <<~STR
+        a => 7
+        b => 54
+        a: status=0 more=5
+        b: status=0 more=7
+        deep => 1
+        deep: status=0 more=601
+        error: syntax error, unexpected '*', expecting NUMBER or '('
+        error: status=1 more=2
+        c => 6
+        c: status=0 more=3
+        d => 7
+        d: status=0 more=5
+      STR
+      test_parser("push", "1 + 2 * 3", expected)
+    end
+  end
+
+  describe "calculator with api.parser-context" do
+    it "returns 9 for '(1+2)*3'" do
+      test_parser("calculator", "( 1 + 2 ) * 3", "=> 9", lrama_command_args: %W[-Dapi.parser-context])
+    end
+  end
+
+  describe "api.parser-context" do
+    let(:expected) do
+      <<~STR
+        => 7
+        status=0
+        => 1
+        status=0
+        memory exhausted
+        status=2
+        => 14
+        status=0
+      STR
+    end
+
+    it "reuses a context after its stacks grow and hit the maximum depth" do
+      test_parser("parser_context", "1 + 2 * 3", expected)
+    end
+
+    it "reuses a context with error recovery" do
+      test_parser("parser_context", "1 + 2 * 3", expected, lrama_command_args: %W[-e])
+    end
+  end
+
+  describe "api.location.type compact" do
+    it "tracks offsets and maps them to lines and columns" do
+      expected = <<~STR
+        3 expr: 0-5 (1.1-1.6)
+        7 expr: 7-15 (2.1-3.4)
+        syntax error, unexpected '+', expecting NUMBER or '(': 21-22 (4.5-4.6)
+        error: 17-24 (4.1-4.8)
+        line: 17-25 (4.1-4.9)
+        7 expr: 26-27 (5.1-5.2)
+        status=0
+        offset 29: 0 (6.1)
+        offset 30: 1
+      STR
+      test_parser("compact_location", "1 + 2;\n(3 +\n 4);\n5 + + 6;\n7;\n", expected)
+    end
+  end
+
   describe "parser without %union (YYSTYPE defaults to int)" do
     it "returns 6 for '1 + 2 + 3'" do
       test_parser("no_union", "1 + 2 + 3", "=> 6\n")
     end
   end
 
+  describe "scanner returns YYerror without %locations" do
+    it "recovers without reporting a syntax error" do
+      test_parser("scanner_error", "1+2\n3!4\n5\n", "3\nrecovered\n5\nnerr=0\n")
+    end
+  end
+
   it "prologue and epilogue are optional" do
     test_parser("prologue_epilogue_optional", "", "")
   end
@@ -289,6 +390,15 @@ RSpec.describe "integration" do
       # '100' is complemented
       test_parser("error_recovery", "(1+)", "=> 101", lrama_command_args: %W[-e])
     end
+
+    it "returns 101 for '(1+)' with yacc-direct.c skeleton" do
+      test_parser("error_recovery", "(1+)", "=> 101", lrama_command_args: %W[-e -Sbison/yacc-direct.c])
+    end
+
+    it "returns 101 for '(1+)' with lr.unit-rule-elimination" do
+      # Unit rules are not bypassed with -e
+      test_parser("error_recovery", "(1+)", "=> 101", lrama_command_args: %W[-e -Dlr.unit-rule-elimination])
+    end
   end
 
   describe "sample files" do
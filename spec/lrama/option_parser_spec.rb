@@ -59,6 +59,7 @@ RSpec.describe Lrama::OptionParser do
               -r, --report=REPORTS             also produce details on the automaton
                   --report-file=FILE           also produce details on the automaton output to a file named FILE
               -o, --output=FILE                leave output to FILE
+                  --table-compression=LEVEL    compress parser tables at LEVEL (default, max)
                   --trace=TRACES               also output trace logs at runtime
                   --diagram=[FILE]             generate a diagram of the rules
                   --profile=PROFILES           profiles parser generation parts
@@ -71,6 +72,7 @@ RSpec.describe Lrama::OptionParser do
               -e                               enable error recovery
 
           Other options:
+              -j, --jobs=N                     use N worker processes to build states
               -V, --version                    output version information and exit
               -h, --help                       display this help and exit
 
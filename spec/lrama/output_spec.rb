@@ -7,7 +7,7 @@ RSpec.describe Lrama::Output do
     Lrama::Output.new(
       out: out,
       output_file_path: "y.tab.c",
-      template_name: "bison/yacc.c",
+      template_name: template_name,
       grammar_file_path: grammar_file_path,
       header_out: header_out,
       header_file_path: header_file_path,
@@ -15,6 +15,7 @@ RSpec.describe Lrama::Output do
       grammar: grammar,
     )
   }
+  let(:template_name) { "bison/yacc.c" }
   let(:out) { StringIO.new }
   let(:header_out) { StringIO.new }
   let(:text) { File.read(grammar_file_path) }
@@ -202,5 +203,149 @@ RSpec.describe Lrama::Output do
         expect(o).not_to match(/\[@ofile@\]/)
       end
     end
+
+    context "template_name is bison/yacc-direct.c" do
+      let(:template_name) { "bison/yacc-direct.c" }
+
+      before do
+        output.render
+        out.rewind
+      end
+
+      it "renders code of each state" do
+        o = out.read
+
+        expect(o).to include('#define YYSKELETON_NAME "yacc-direct.c"')
+        expect(o).not_to match(/\[@oline@\]/)
+        states.states.each do |state|
+          expect(o).to include("      case #{state.id}: goto yystate_#{state.id};\n")
+          expect(o).to include("\nyystate_#{state.id}:\n")
+        end
+        expect(o).to include("\nyyread:\n")
+        expect(o).not_to include("\nyydefault:\n")
+      end
+    end
+
+    context "locations are not used" do
+      before do
+        output.render
+        out.rewind
+      end
+
+      it "renders no location stack" do
+        o = out.read
+
+        expect(grammar.locations).to be_falsey
+        expect(o).not_to include("yylsp")
+        expect(o).not_to include("YYLLOC_DEFAULT (yyloc")
+        expect(o).to include("#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))\n")
+      end
+    end
+
+    context "locations are used" do
+      let(:text) { File.read(grammar_file_path).sub("%define api.pure\n", "%define api.pure\n%locations\n").sub("{ code 3 }", "{ code 3; @$; @1; }").sub("{ code 5 }", "{ code 5; @1.first_column = 99; }") }
+
+      before do
+        output.render
+        out.rewind
+      end
+
+      it "renders location stack" do
+        o = out.read
+
+        expect(o).to include("  YYLTYPE yylsa[YYINITDEPTH];\n")
+        expect(o).to include("#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))\n")
+      end
+
+      it "computes yyloc only for the actions which refer to a location" do
+        o = out.read
+        yyrloc = context.yyrloc
+
+        expect(yyrloc.count).to eq(context.yyr2.count)
+        expect(yyrloc.each_index.select {|i| yyrloc[i] == 1 }).to eq([" code 3; @$; @1; ", " code 5; @1.first_column = 99; "].map {|code| states.rules.find {|rule| rule.token_code&.s_value == code }.id + 1 })
+        expect(o).to include("static const yytype_int8 yyrloc[] =\n")
+        expect(o).to include("  if (yyrloc[yyn])\n    YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);\n")
+        expect(o).to include("  if (yyrloc[yyn])\n    yylsp[1] = yyloc;\n  else\n    YYLLOC_DEFAULT_TOP (yylsp, yylen);\n")
+      end
+    end
+
+    context "api.location.type is compact" do
+      let(:text) { File.read(grammar_file_path).sub("%define api.pure\n", "%define api.pure\n%locations\n%define api.location.type compact\n") }
+
+      before do
+        output.render
+        out.rewind
+        header_out.rewind
+      end
+
+      it "renders locations of offsets and the line index" do
+        o = out.read
+        h = header_out.read
+
+        expect(h).to include("struct YYLTYPE\n{\n  int begin_offset;\n  int end_offset;\n};\n")
+        expect(h).not_to include("first_line")
+        expect(h).to include("yyline_index *yyline_index_new (const char *text, long length);\n")
+        expect(h).to include("int yyline_index_lookup (yyline_index *index, long offset, int *line, int *column);\n")
+        expect(h).to include("void yyline_index_delete (yyline_index *index);\n")
+        expect(o).to include("          (Current).begin_offset = YYRHSLOC (Rhs, 1).begin_offset;      \\\n")
+        expect(o).to include("  = { 0, 0 }\n")
+        expect(o).to include("\nyyline_index_lookup (yyline_index *yyindex, long offset, int *line, int *column)\n")
+        expect(o).not_to include("first_line")
+      end
+    end
+
+    context "@$ is referred in %printer" do
+      let(:text) { File.read(grammar_file_path).sub("%define api.pure\n", "%define api.pure\n%printer { print_location(@$); } <i>\n") }
+
+      it "enables locations" do
+        expect(grammar.locations).to be_truthy
+      end
+    end
+
+    context "api.push-pull is both" do
+      let(:text) { File.read(grammar_file_path).sub("%define api.pure\n", "%define api.pure\n%define api.push-pull both\n") }
+
+      before do
+        output.render
+        out.rewind
+        header_out.rewind
+      end
+
+      it "renders push parser and pull parser interfaces" do
+        o = out.read
+        h = header_out.read
+
+        expect(o).to include("#define YYPUSH 1\n")
+        expect(o).to include("#define YYPULL 1\n")
+        expect(o).to include("struct yypstate\n")
+        expect(o).to include("\nyypull_parse (yypstate *yyps, struct parse_params *p)\n")
+        expect(o).to include("\nyypush_parse (yypstate *yyps,\n")
+        expect(h).to include("int yyparse (struct parse_params *p);\n")
+        expect(h).to include("yypstate *yypstate_new (void);\n")
+        expect(h).to include("void yypstate_delete (yypstate *ps);\n")
+      end
+    end
+
+    context "api.parser-context is defined" do
+      let(:text) { File.read(grammar_file_path).sub("%define api.pure\n", "%define api.pure\n%define api.parser-context\n") }
+
+      before do
+        output.render
+        out.rewind
+        header_out.rewind
+      end
+
+      it "renders yyparse_context_parse and yyparse wrapping it" do
+        o = out.read
+        h = header_out.read
+
+        expect(o).to include("struct yyparse_context\n")
+        expect(o).to include("  yyresult = yyparse_context_parse (&yyctx, p);\n")
+        expect(o).to include("\nyyparse_context_parse (yyparse_context *yyctx, struct parse_params *p)\n")
+        expect(h).to include("int yyparse (struct parse_params *p);\n")
+        expect(h).to include("yyparse_context *yyparse_context_new (long initdepth, long maxdepth);\n")
+        expect(h).to include("void yyparse_context_delete (yyparse_context *ctx);\n")
+      end
+    end
   end
 end
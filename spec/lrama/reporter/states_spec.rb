@@ -139,4 +139,52 @@ RSpec.describe Lrama::Reporter::States do
       STR
     end
   end
+
+  describe "#report_unit_rule_bypasses" do
+    it "reports the number of removed unit rule reductions" do
+      y = <<~INPUT
+        %token tNUMBER
+
+        %%
+
+        program: expr
+               ;
+
+        expr: term
+            | expr '+' term
+            ;
+
+        term: tNUMBER
+            ;
+
+        %%
+      INPUT
+
+      grammar = Lrama::Parser.new(y, "unit_rules.y").parse
+      grammar.prepare
+      grammar.validate!
+      states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new))
+      states.compute
+      states.compute_unit_rule_elimination
+
+      io = StringIO.new
+      Lrama::Reporter.new(states: true).report(io, states)
+
+      expect(io.string).to include(<<~STR)
+        State 0
+
+            0 $accept: • program "end of file"
+
+            tNUMBER  shift, and go to state 1
+
+            program  go to state 2
+            expr     go to state 3
+            term     go to state 4
+
+            tNUMBER  go to state 3 instead of state 1, 2 unit rule reductions removed
+            term     go to state 3 instead of state 4, 1 unit rule reduction removed
+
+      STR
+    end
+  end
 end
@@ -1114,6 +1114,77 @@ RSpec.describe Lrama::States do
         STR
       end
     end
+
+    describe "with jobs" do
+      it "computes the same relations as the serial mode" do
+        skip "fork is not supported" unless Process.respond_to?(:fork)
+
+        path = "common/basic.y"
+        y = File.read(fixture_path(path))
+        computed = [1, 3].map do |jobs|
+          grammar = Lrama::Parser.new(y, path).parse
+          grammar.prepare
+          grammar.validate!
+          states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new), jobs: jobs)
+          states.compute
+
+          io = StringIO.new
+          Lrama::Reporter.new(states: true, lookaheads: true).report(io, states)
+
+          relations = %i[@direct_read_sets @reads_relation @includes_relation @lookback_relation].map {|name| states.instance_variable_get(name) }
+          [relations, io.string]
+        end
+
+        expect(computed[1]).to eq(computed[0])
+      end
+
+      it "builds the same LR(0) states as the serial mode" do
+        skip "fork is not supported" unless Process.respond_to?(:fork)
+
+        # The second frontier is large enough to be split among workers
+        tokens = (0...(Lrama::States::LR0_MIN_CHUNK_SIZE * 3)).map {|i| "t#{i}" }
+        y = <<~GRAMMAR
+          %token #{tokens.join(" ")}
+          %%
+          program: #{tokens.map {|t| "#{t} expr" }.join(" | ")} ;
+          expr: #{tokens.first} | expr '+' #{tokens.last} ;
+          %%
+        GRAMMAR
+        reports = [1, 3].map do |jobs|
+          grammar = Lrama::Parser.new(y, "frontier.y").parse
+          grammar.prepare
+          grammar.validate!
+          states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new), jobs: jobs)
+          states.compute
+
+          io = StringIO.new
+          Lrama::Reporter.new(states: true, itemsets: true, lookaheads: true).report(io, states)
+          io.string
+        end
+
+        expect(reports[1]).to eq(reports[0])
+      end
+
+      it "re-raises the exception raised in a worker" do
+        skip "fork is not supported" unless Process.respond_to?(:fork)
+
+        path = "common/basic.y"
+        grammar = Lrama::Parser.new(File.read(fixture_path(path)), path).parse
+        grammar.prepare
+        grammar.validate!
+        states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new), jobs: 3)
+
+        expect {
+          states.send(:parallel_map, (1..9).to_a) {|i| i == 7 ? raise(ArgumentError, "invalid item #{i}") : i }
+        }.to raise_error(ArgumentError, "invalid item 7")
+
+        expect {
+          states.send(:parallel_map, (1..9).to_a) {|i| i == 7 ? raise(ArgumentError.new("invalid item #{i}").tap {|e| e.instance_variable_set(:@proc, -> {}) }) : i }
+        }.to raise_error(RuntimeError, "ArgumentError: invalid item 7")
+
+        expect(states.send(:parallel_map, (1..9).to_a) {|i| i * 2 }).to eq((1..9).map {|i| i * 2 })
+      end
+    end
   end
 
   describe '#compute_conflicts' do
@@ -1875,6 +1946,91 @@ RSpec.describe Lrama::States do
     end
   end
 
+  describe '#compute_unit_rule_elimination' do
+    let(:y) do
+      <<~INPUT
+        %union {
+            int i;
+        }
+
+        %token <i> NUM
+        %type <i> expr term primary
+        %destructor { free_term($$); } <i>
+        %destructor { } NUM
+
+        %%
+
+        program: expr ;
+
+        expr: term
+            | expr '+' term { $$ = $1 + $3; }
+            ;
+
+        term: primary
+            | term '*' primary { $$ = $1 * $3; }
+            ;
+
+        primary: NUM
+               | '(' expr ')' { $$ = $2; }
+               ;
+
+        %%
+      INPUT
+    end
+
+    let(:grammar) do
+      grammar = Lrama::Parser.new(y, "unit_rules.y").parse
+      grammar.prepare
+      grammar.validate!
+      grammar
+    end
+
+    let(:states) do
+      states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new))
+      states.compute
+      states.compute_unit_rule_elimination
+      states
+    end
+
+    it "bypasses chains of unit rules without action" do
+      state = states.states[0]
+      term = grammar.find_symbol_by_s_value!("term")
+      primary = grammar.find_symbol_by_s_value!("primary")
+
+      # `term: primary` is reduced, then goto by term
+      expect(state.unit_rule_bypasses).to eq({ primary => [state.transition(term), 1] })
+    end
+
+    it "does not bypass a unit rule whose symbols have different destructors" do
+      num = grammar.find_symbol_by_s_value!("NUM")
+
+      states.states.each do |state|
+        expect(state.unit_rule_bypasses.keys).not_to include(num)
+      end
+    end
+
+    context "when destructors are shared" do
+      let(:y) { super().sub("%destructor { } NUM\n", "") }
+
+      it "bypasses a unit rule of a terminal" do
+        state = states.states[0]
+        term = grammar.find_symbol_by_s_value!("term")
+        num = grammar.find_symbol_by_s_value!("NUM")
+
+        # `primary: NUM` and `term: primary` are reduced
+        expect(state.unit_rule_bypasses[num]).to eq([state.transition(term), 2])
+      end
+    end
+
+    context "when %after-reduce is specified" do
+      let(:y) { super().sub("%%\n", "%after-reduce after_reduce\n\n%%\n") }
+
+      it "does not bypass any states" do
+        expect(states.states.map(&:unit_rule_bypasses).reject(&:empty?)).to eq([])
+      end
+    end
+  end
+
   describe '#compute_ielr' do
     it 'recompute states' do
       path = "integration/ielr.y"
@@ -3159,4 +3315,44 @@ RSpec.describe Lrama::States do
       end
     end
   end
+
+  describe "look-ahead bitmap of reduces" do
+    it "is converted to symbols lazily and used for conflicts" do
+      y = <<~INPUT
+        %{
+        // Prologue
+        %}
+
+        %token EOI 0 "EOI"
+        %token a b
+
+        %%
+
+        program: x a
+               | y a
+               | x b
+               ;
+
+        x: ;
+        y: ;
+
+        %%
+      INPUT
+      grammar = Lrama::Parser.new(y, "states/look_ahead_bitmap.y").parse
+      grammar.prepare
+      grammar.validate!
+      states = Lrama::States.new(grammar, Lrama::Tracer.new(Lrama::Logger.new))
+      states.compute
+
+      state = states.states.first
+      reduce_x, reduce_y = state.reduces
+      a = grammar.find_symbol_by_s_value!("a")
+      b = grammar.find_symbol_by_s_value!("b")
+
+      expect(reduce_x.look_ahead_bitmap.to_a).to eq([a.number, b.number])
+      expect(reduce_x.look_ahead).to eq([a, b])
+      expect(reduce_y.look_ahead).to eq([a])
+      expect(state.rr_conflicts.map(&:symbols)).to eq([[a]])
+    end
+  end
 end
@@ -53,6 +53,14 @@ typedef int YYSTYPE;
 /* Location type.  */
 #if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
 typedef struct YYLTYPE YYLTYPE;
+<%- if output.compact_location_defined? -%>
+/* Offsets of the first byte and of the byte past the last one.  */
+struct YYLTYPE
+{
+  int begin_offset;
+  int end_offset;
+};
+<%- else -%>
 struct YYLTYPE
 {
   int first_line;
@@ -60,16 +68,54 @@ struct YYLTYPE
   int last_line;
   int last_column;
 };
+<%- end -%>
 # define YYLTYPE_IS_DECLARED 1
 # define YYLTYPE_IS_TRIVIAL 1
 #endif
+<%- if output.compact_location_defined? -%>
+
+/* Map from the offsets of locations to lines and columns of TEXT.  */
+typedef struct yyline_index yyline_index;
+
+yyline_index *yyline_index_new (const char *text, long length);
+int yyline_index_lookup (yyline_index *index, long offset, int *line, int *column);
+void yyline_index_delete (yyline_index *index);
+<%- end -%>
 
 
 
 
   <%-# b4_declare_yyerror_and_yylex. Not supported -%>
   <%-# b4_declare_yyparse -%>
+<%- if output.push_parser_defined? -%>
+#ifndef YYPUSH_MORE_DEFINED
+# define YYPUSH_MORE_DEFINED
+enum { YYPUSH_MORE = 4 };
+#endif
+
+typedef struct yypstate yypstate;
+
+<%- if output.pull_parser_defined? -%>
+int yyparse (<%= output.parse_param %>);
+<%- end -%>
+int yypush_parse (yypstate *ps,
+                  int pushed_char, YYSTYPE const *pushed_val, YYLTYPE *pushed_loc<%= output.user_formals %>);
+<%- if output.pull_parser_defined? -%>
+int yypull_parse (yypstate *ps<%= output.user_formals %>);
+<%- end -%>
+yypstate *yypstate_new (void);
+yypstate *yypstate_new_depth (long initdepth, long maxdepth);
+void yypstate_delete (yypstate *ps);
+<%- elsif output.parser_context_defined? -%>
+typedef struct yyparse_context yyparse_context;
+
+int yyparse (<%= output.parse_param %>);
+int yyparse_context_parse (yyparse_context *ctx<%= output.user_formals %>);
+yyparse_context *yyparse_context_new (long initdepth, long maxdepth);
+void yyparse_context_delete (yyparse_context *ctx);
+<%- else -%>
 int yyparse (<%= output.parse_param %>);
+<%- end -%>
 
 
 <%= output.percent_code("provides") %>
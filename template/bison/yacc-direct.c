@@ -0,0 +1,3 @@
+<%# Same with yacc.c except that yyparse jumps to the code of each state -%>
+<%# instead of looking up yypact and yytable, see Output#direct_states. -%>
+<%= output.render_partial("bison/yacc.c") -%>
@@ -62,10 +62,10 @@
 #define YYPURE 1
 
 /* Push parsers.  */
-#define YYPUSH 0
+#define YYPUSH <%= output.push_parser_defined? ? 1 : 0 %>
 
 /* Pull parsers.  */
-#define YYPULL 1
+#define YYPULL <%= output.pull_parser_defined? ? 1 : 0 %>
 
 
 <%# b4_user_pre_prologue -%>
@@ -316,6 +316,7 @@ typedef int yy_state_fast_t;
 #if 1
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
+<%- unless output.push_parser_defined? || output.parser_context_defined? -%>
 
 # ifdef YYSTACK_USE_ALLOCA
 #  if YYSTACK_USE_ALLOCA
@@ -340,6 +341,7 @@ typedef int yy_state_fast_t;
 #   endif
 #  endif
 # endif
+<%- end -%>
 
 # ifdef YYSTACK_ALLOC
    /* Pacify GCC's 'empty if-body' warning.  */
@@ -382,15 +384,21 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
+<%- if output.grammar.locations -%>
          || (defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL \
              && defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+<%- else -%>
+         || (defined YYSTYPE_IS_TRIVIAL && YYSTYPE_IS_TRIVIAL)))
+<%- end -%>
 
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
   yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
+<%- if output.grammar.locations -%>
   YYLTYPE yyls_alloc;
+<%- end -%>
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
@@ -398,10 +406,16 @@ union yyalloc
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
+<%- if output.grammar.locations -%>
 # define YYSTACK_BYTES(N) \
      ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
              + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
+<%- else -%>
+# define YYSTACK_BYTES(N) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE)) \
+      + YYSTACK_GAP_MAXIMUM)
+<%- end -%>
 
 # define YYCOPY_NEEDED 1
 
@@ -530,6 +544,7 @@ static const <%= output.int_type_for(output.context.yypact) %> yypact[] =
 <%= output.int_array_to_string(output.context.yypact) %>
 };
 
+<%- if !output.direct_parser? || output.error_recovery -%>
 /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
    Performed when YYTABLE does not specify something else to do.  Zero
    means the default is an error.  */
@@ -537,7 +552,25 @@ static const <%= output.int_type_for(output.context.yydefact) %> yydefact[] =
 {
 <%= output.int_array_to_string(output.context.yydefact) %>
 };
+<%- end -%>
+
+<%- if output.dense_tables_defined? -%>
+/* YYDENSE_ACTION[STATE-NUM * YYNTOKENS + SYMBOL-NUM] -- What to do in
+   state STATE-NUM on SYMBOL-NUM.  If positive, shift that token.  If
+   negative, reduce the rule whose number is the opposite.  If
+   YYTABLE_NINF, syntax error.  If zero, do the default action.  */
+static const <%= output.int_type_for(output.context.yydense_action) %> yydense_action[] =
+{
+<%= output.int_array_to_string(output.context.yydense_action) %>
+};
 
+/* YYDENSE_GOTO[STATE-NUM * YYNNTS + NTERM-NUM] -- State to go to after
+   reducing to NTERM-NUM in state STATE-NUM.  */
+static const <%= output.int_type_for(output.context.yydense_goto) %> yydense_goto[] =
+{
+<%= output.int_array_to_string(output.context.yydense_goto) %>
+};
+<%- else -%>
 /* YYPGOTO[NTERM-NUM].  */
 static const <%= output.int_type_for(output.context.yypgoto) %> yypgoto[] =
 {
@@ -562,6 +595,7 @@ static const <%= output.int_type_for(output.context.yycheck) %> yycheck[] =
 {
 <%= output.int_array_to_string(output.context.yycheck) %>
 };
+<%- end -%>
 
 /* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
    state STATE-NUM.  */
@@ -581,6 +615,16 @@ static const <%= output.int_type_for(output.context.yyr2) %> yyr2[] =
 {
 <%= output.int_array_to_string(output.context.yyr2) %>
 };
+<%- if output.grammar.locations -%>
+
+/* YYRLOC[RULE-NUM] -- Whether the action of rule RULE-NUM refers to a
+   location (@$ or @N).  The location of the other rules is computed on
+   the stack after the action.  */
+static const <%= output.int_type_for(output.context.yyrloc) %> yyrloc[] =
+{
+<%= output.int_array_to_string(output.context.yyrloc) %>
+};
+<%- end -%>
 
 
 enum { YYENOMEM = -2 };
@@ -623,6 +667,29 @@ enum { YYENOMEM = -2 };
    the previous symbol: RHS[0] (always defined).  */
 
 #ifndef YYLLOC_DEFAULT
+<%- if output.compact_location_defined? -%>
+# define YYLLOC_DEFAULT(Current, Rhs, N)                                \
+    do                                                                  \
+      if (N)                                                            \
+        {                                                               \
+          (Current).begin_offset = YYRHSLOC (Rhs, 1).begin_offset;      \
+          (Current).end_offset   = YYRHSLOC (Rhs, N).end_offset;        \
+        }                                                               \
+      else                                                              \
+        (Current).begin_offset = (Current).end_offset =                 \
+          YYRHSLOC (Rhs, 0).end_offset;                                 \
+    while (0)
+
+/* The start of RHS[1] is kept, and nothing is done for one symbol.  */
+# define YYLLOC_DEFAULT_TOP(Rhs, N)                                     \
+    do                                                                  \
+      if (1 < (N))                                                      \
+        YYRHSLOC (Rhs, 1).end_offset = YYRHSLOC (Rhs, N).end_offset;    \
+      else if ((N) == 0)                                                \
+        YYRHSLOC (Rhs, 1).begin_offset = YYRHSLOC (Rhs, 1).end_offset = \
+          YYRHSLOC (Rhs, 0).end_offset;                                 \
+    while (0)
+<%- else -%>
 # define YYLLOC_DEFAULT(Current, Rhs, N)                                \
     do                                                                  \
       if (N)                                                            \
@@ -640,9 +707,120 @@ enum { YYENOMEM = -2 };
             YYRHSLOC (Rhs, 0).last_column;                              \
         }                                                               \
     while (0)
+
+/* The start of RHS[1] is kept, and nothing is done for one symbol.  */
+# define YYLLOC_DEFAULT_TOP(Rhs, N)                                     \
+    do                                                                  \
+      if (1 < (N))                                                      \
+        {                                                               \
+          YYRHSLOC (Rhs, 1).last_line   = YYRHSLOC (Rhs, N).last_line;  \
+          YYRHSLOC (Rhs, 1).last_column = YYRHSLOC (Rhs, N).last_column;\
+        }                                                               \
+      else if ((N) == 0)                                                \
+        {                                                               \
+          YYRHSLOC (Rhs, 1).first_line   = YYRHSLOC (Rhs, 1).last_line   = \
+            YYRHSLOC (Rhs, 0).last_line;                                \
+          YYRHSLOC (Rhs, 1).first_column = YYRHSLOC (Rhs, 1).last_column = \
+            YYRHSLOC (Rhs, 0).last_column;                              \
+        }                                                               \
+    while (0)
+<%- end -%>
+#endif
+
+/* YYLLOC_DEFAULT_TOP -- Replace the location of RHS[1] with the one
+   YYLLOC_DEFAULT would set, in place on the location stack.  It is used
+   for the rules whose action does not refer to any location.  */
+
+#ifndef YYLLOC_DEFAULT_TOP
+# define YYLLOC_DEFAULT_TOP(Rhs, N)                                     \
+    do                                                                  \
+      {                                                                 \
+        YYLTYPE yylhsloc;                                               \
+        YYLLOC_DEFAULT (yylhsloc, Rhs, N);                              \
+        YYRHSLOC (Rhs, 1) = yylhsloc;                                   \
+      }                                                                 \
+    while (0)
 #endif
 
 #define YYRHSLOC(Rhs, K) ((Rhs)[K])
+<%- if output.compact_location_defined? -%>
+
+
+/* Start offsets of the lines of the text, built by the first lookup.  */
+struct yyline_index
+{
+  const char *yytext;
+  long yylength;
+  long *yystarts;
+  long yycount;
+};
+
+yyline_index *
+yyline_index_new (const char *text, long length)
+{
+  yyline_index *yyindex;
+  yyindex = YY_CAST (yyline_index *, YYMALLOC (sizeof *yyindex));
+  if (!yyindex)
+    return YY_NULLPTR;
+  yyindex->yytext = text;
+  yyindex->yylength = length;
+  yyindex->yystarts = YY_NULLPTR;
+  yyindex->yycount = 0;
+  return yyindex;
+}
+
+/* Set *LINE and *COLUMN, which start at 1, to the position of OFFSET.
+   Return nonzero if OFFSET is out of the text or memory is exhausted.  */
+int
+yyline_index_lookup (yyline_index *yyindex, long offset, int *line, int *column)
+{
+  long yylow, yyhigh;
+  if (offset < 0 || yyindex->yylength < offset)
+    return 1;
+  if (!yyindex->yystarts)
+    {
+      long yyi;
+      long yycount = 1;
+      for (yyi = 0; yyi < yyindex->yylength; yyi++)
+        if (yyindex->yytext[yyi] == '\n')
+          yycount++;
+      yyindex->yystarts =
+        YY_CAST (long *, YYMALLOC (YY_CAST (YYSIZE_T, yycount) * sizeof (long)));
+      if (!yyindex->yystarts)
+        return 1;
+      yyindex->yystarts[0] = 0;
+      yyindex->yycount = 1;
+      for (yyi = 0; yyi < yyindex->yylength; yyi++)
+        if (yyindex->yytext[yyi] == '\n')
+          yyindex->yystarts[yyindex->yycount++] = yyi + 1;
+    }
+  /* Find the last line which starts at or before OFFSET.  */
+  yylow = 0;
+  yyhigh = yyindex->yycount - 1;
+  while (yylow < yyhigh)
+    {
+      long yymid = yyhigh - (yyhigh - yylow) / 2;
+      if (yyindex->yystarts[yymid] <= offset)
+        yylow = yymid;
+      else
+        yyhigh = yymid - 1;
+    }
+  *line = YY_CAST (int, yylow + 1);
+  *column = YY_CAST (int, offset - yyindex->yystarts[yylow] + 1);
+  return 0;
+}
+
+void
+yyline_index_delete (yyline_index *yyindex)
+{
+  if (yyindex)
+    {
+      if (yyindex->yystarts)
+        YYFREE (yyindex->yystarts);
+      YYFREE (yyindex);
+    }
+}
+<%- end -%>
 
 
 /* Enable debugging if requested.  */
@@ -681,6 +859,16 @@ YY_ATTRIBUTE_UNUSED
 static int
 yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
 {
+<%- if output.compact_location_defined? -%>
+  int res = 0;
+  int end = 0 != yylocp->end_offset ? yylocp->end_offset - 1 : 0;
+  if (0 <= yylocp->begin_offset)
+    {
+      res += YYFPRINTF (yyo, "%d", yylocp->begin_offset);
+      if (yylocp->begin_offset < end)
+        res += YYFPRINTF (yyo, "-%d", end);
+    }
+<%- else -%>
   int res = 0;
   int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
   if (0 <= yylocp->first_line)
@@ -700,6 +888,7 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
       else if (0 <= end_col && yylocp->first_column < end_col)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
+<%- end -%>
   return res;
 }
 
@@ -768,8 +957,10 @@ yy_symbol_print (FILE *yyo,
   YYFPRINTF (yyo, "%s %s (",
              yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
+<%- if output.grammar.locations -%>
   YYLOCATION_PRINT (yyo, yylocationp<%= output.user_args %>);
   YYFPRINTF (yyo, ": ");
+<%- end -%>
   yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp<%= output.user_args %>);
   YYFPRINTF (yyo, ")");
 }
@@ -803,8 +994,13 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
+<%- if output.grammar.locations -%>
 yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
                  int yyrule<%= output.user_formals %>)
+<%- else -%>
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp,
+                 int yyrule<%= output.user_formals %>)
+<%- end -%>
 {
   int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
@@ -818,7 +1014,11 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
       yy_symbol_print (stderr,
                        YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
                        &yyvsp[(yyi + 1) - (yynrhs)],
+<%- if output.grammar.locations -%>
                        &(yylsp[(yyi + 1) - (yynrhs)])<%= output.user_args %>);
+<%- else -%>
+                       YY_NULLPTR<%= output.user_args %>);
+<%- end -%>
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -826,7 +1026,11 @@ yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
 # define YY_REDUCE_PRINT(Rule<%= output.user_args %>) \
 do {                                    \
   if (yydebug)                          \
+<%- if output.grammar.locations -%>
     yy_reduce_print (yyssp, yyvsp, yylsp, Rule<%= output.user_args %>); \
+<%- else -%>
+    yy_reduce_print (yyssp, yyvsp, Rule<%= output.user_args %>); \
+<%- end -%>
 } while (0)
 
 /* Nonzero means print parse trace.  It is left uninitialized so that
@@ -882,6 +1086,13 @@ yypcontext_expected_tokens (const yypcontext_t *yyctx,
   int yyn = yypact[+*yyctx->yyssp];
   if (!yypact_value_is_default (yyn))
     {
+<%- if output.dense_tables_defined? -%>
+      const int yybase = +*yyctx->yyssp * YYNTOKENS;
+      int yyx;
+      for (yyx = 0; yyx < YYNTOKENS; ++yyx)
+        if (yydense_action[yybase + yyx] != 0 && yyx != YYSYMBOL_YYerror
+            && !yytable_value_is_error (yydense_action[yybase + yyx]))
+<%- else -%>
       /* Start YYX at -YYN if negative to avoid negative indexes in
          YYCHECK.  In other words, skip the first -YYN actions for
          this state because they are default actions.  */
@@ -893,6 +1104,7 @@ yypcontext_expected_tokens (const yypcontext_t *yyctx,
       for (yyx = yyxbegin; yyx < yyxend; ++yyx)
         if (yycheck[yyx + yyn] == yyx && yyx != YYSYMBOL_YYerror
             && !yytable_value_is_error (yytable[yyx + yyn]))
+<%- end -%>
           {
             if (!yyarg)
               ++yycount;
@@ -1161,10 +1373,32 @@ yydestruct (const char *yymsg,
 # define YYMAXREPAIR(<%= output.parse_param_name %>) (3)
 #endif
 
+#ifndef YYMAXREPAIRWORK
+# define YYMAXREPAIRWORK(<%= output.parse_param_name %>) (10000)
+#endif
+
 #ifndef YYERROR_RECOVERY_ENABLED
 # define YYERROR_RECOVERY_ENABLED(<%= output.parse_param_name %>) (1)
 #endif
 
+/* YYREPAIR_DIST[YYREPAIR_DIST_ROW[STATE-NUM] * YYNTOKENS + TOKEN-NUM] -- A
+   lower bound of the number of tokens to insert in STATE-NUM before
+   TOKEN-NUM is shifted, YYREPAIR_DIST_MAX if it never is.  */
+#define YYREPAIR_DIST_MAX <%= Lrama::Context::RepairDistMax %>
+
+static const <%= output.int_type_for(output.context.yyrepair_dist) %> yyrepair_dist[] =
+{
+<%= output.int_array_to_string(output.context.yyrepair_dist) %>
+};
+
+static const <%= output.int_type_for(output.context.yyrepair_dist_row) %> yyrepair_dist_row[] =
+{
+<%= output.int_array_to_string(output.context.yyrepair_dist_row) %>
+};
+
+#define YYREPAIR_DIST(State, Token) \
+  (yyrepair_dist[yyrepair_dist_row[State] * YYNTOKENS + (Token)])
+
 enum yy_repair_type {
   inserting,
   deleting,
@@ -1177,16 +1411,45 @@ struct yy_repair {
 };
 typedef struct yy_repair yy_repair;
 
+/* A type that is properly aligned for any arena allocation.  */
+union yy_arena_align {
+  void *yyptr;
+  YYPTRDIFF_T yyn;
+  double yyd;
+};
+typedef union yy_arena_align yy_arena_align;
+
+struct yy_arena_chunk {
+  struct yy_arena_chunk *next;
+  /* Capacity and used part of data, in units of yy_arena_align */
+  YYPTRDIFF_T size;
+  YYPTRDIFF_T used;
+  yy_arena_align data[];
+};
+typedef struct yy_arena_chunk yy_arena_chunk;
+
+/* Memory of one error recovery, released at once by yy_arena_free.  */
+struct yy_arena {
+  yy_arena_chunk *chunk;
+};
+typedef struct yy_arena yy_arena;
+
 struct yy_repairs {
-  /* For debug */
+  /* For debug, and for ordering candidates of the same cost */
   int id;
-  /* For breadth-first traversing */
-  struct yy_repairs *next;
-  YYPTRDIFF_T stack_length;
-  /* Bottom of states */
+  /* repair_length plus a lower bound of the tokens still to insert */
+  int cost;
+  /* Hash of the stack */
+  YYSIZE_T hash;
+  /* Number of states at the bottom of the parser's stack which are
+     shared as is */
+  YYPTRDIFF_T base;
+  /* Number of states pushed on top of them */
+  YYPTRDIFF_T length;
+  /* States pushed on top of the shared ones */
   yy_state_t *states;
   /* Top of states */
-  yy_state_t *state;
+  yy_state_t state;
   /* repair length */
   int repair_length;
   /*  */
@@ -1195,6 +1458,38 @@ struct yy_repairs {
 };
 typedef struct yy_repairs yy_repairs;
 
+/* The stack a candidate repair is processed on.  */
+struct yy_repair_stack {
+  /* The parser's stack whose bottom BASE states are shared */
+  const yy_state_t *yyss;
+  YYPTRDIFF_T base;
+  /* States pushed on top of them, and its capacity */
+  yy_state_t *states;
+  YYPTRDIFF_T length;
+  YYPTRDIFF_T size;
+  /* The size the parser's stack can grow to */
+  YYPTRDIFF_T maxdepth;
+  yy_arena *arena;
+};
+typedef struct yy_repair_stack yy_repair_stack;
+
+/* Candidates to expand, a binary heap ordered by cost then by id.  */
+struct yy_repair_queue {
+  yy_repairs **heap;
+  YYPTRDIFF_T length;
+  YYPTRDIFF_T size;
+};
+typedef struct yy_repair_queue yy_repair_queue;
+
+/* Candidates already enqueued, an open addressing hash table keyed by
+   their stacks.  Size is a power of 2.  */
+struct yy_repair_set {
+  yy_repairs **slots;
+  YYPTRDIFF_T count;
+  YYPTRDIFF_T size;
+};
+typedef struct yy_repair_set yy_repair_set;
+
 struct yy_term {
   yysymbol_kind_t kind;
   YYSTYPE value;
@@ -1257,7 +1552,7 @@ yy_print_repairs(yy_repairs *reps<%= output.user_formals %>)
 
   YYDPRINTF ((stderr,
         "id: %d, repair_length: %d, repair_state: %d, prev_repair_id: %d\n",
-        reps->id, reps->repair_length, *reps->state, reps->prev_repair->id));
+        reps->id, reps->repair_length, reps->state, reps->prev_repair->id));
 
   while (r->prev_repair)
   {
@@ -1277,32 +1572,239 @@ yy_print_repair_terms(yy_repair_terms *rep_terms<%= output.user_formals %>)
   YYDPRINTF ((stderr, "\n"));
 }
 
+static void *
+yy_arena_alloc(yy_arena *arena, YYPTRDIFF_T bytes)
+{
+  YYPTRDIFF_T n = (bytes + YYSIZEOF (yy_arena_align) - 1) / YYSIZEOF (yy_arena_align);
+  yy_arena_chunk *chunk = arena->chunk;
+
+  if (!chunk || chunk->size - chunk->used < n)
+    {
+      YYPTRDIFF_T size = chunk ? chunk->size * 2 : 512;
+      if (size < n)
+        size = n;
+      chunk = (yy_arena_chunk *) YYMALLOC (sizeof (yy_arena_chunk) + sizeof (yy_arena_align) * YY_CAST (YYSIZE_T, size));
+      if (!chunk)
+        return YY_NULLPTR;
+      chunk->next = arena->chunk;
+      chunk->size = size;
+      chunk->used = 0;
+      arena->chunk = chunk;
+    }
+
+  chunk->used += n;
+  return chunk->data + chunk->used - n;
+}
+
+static void
+yy_arena_free(yy_arena *arena)
+{
+  while (arena->chunk)
+    {
+      yy_arena_chunk *chunk = arena->chunk;
+      arena->chunk = chunk->next;
+      YYFREE (chunk);
+    }
+}
+
+/* Start STACK from the states of REPS.  Return 0 if memory is exhausted.  */
+static int
+yy_repair_stack_load(yy_repair_stack *stack, const yy_repairs *reps)
+{
+  if (stack->size < reps->length + 1)
+    {
+      YYPTRDIFF_T size = stack->size ? stack->size * 2 : 16;
+      if (size < reps->length + 1)
+        size = reps->length + 1;
+      stack->states = (yy_state_t *) yy_arena_alloc (stack->arena, YYSIZEOF (yy_state_t) * size);
+      if (!stack->states)
+        return 0;
+      stack->size = size;
+    }
+  stack->base = reps->base;
+  stack->length = reps->length;
+  if (reps->length)
+    YYCOPY (stack->states, reps->states, reps->length);
+  return 1;
+}
+
+/* Push STATE on STACK.  Return 0 if the stack can not grow.  */
+static int
+yy_repair_stack_push(yy_repair_stack *stack, yy_state_t state)
+{
+  if (stack->length == stack->size)
+    {
+      yy_state_t *states;
+      if (stack->maxdepth <= stack->base + stack->size)
+        return 0;
+      states = (yy_state_t *) yy_arena_alloc (stack->arena, YYSIZEOF (yy_state_t) * stack->size * 2);
+      if (!states)
+        return 0;
+      YYCOPY (states, stack->states, stack->length);
+      stack->states = states;
+      stack->size *= 2;
+    }
+  stack->states[stack->length++] = state;
+  return 1;
+}
+
 static void
-yy_free_repairs(yy_repairs *reps<%= output.user_formals %>)
+yy_repair_stack_pop(yy_repair_stack *stack, YYPTRDIFF_T n)
+{
+  if (n <= stack->length)
+    stack->length -= n;
+  else
+    {
+      stack->base -= n - stack->length;
+      stack->length = 0;
+    }
+}
+
+static yy_state_t
+yy_repair_stack_top(const yy_repair_stack *stack)
+{
+  return stack->length ? stack->states[stack->length - 1] : stack->yyss[stack->base - 1];
+}
+
+static int
+yy_repairs_before(const yy_repairs *a, const yy_repairs *b)
+{
+  return a->cost < b->cost || (a->cost == b->cost && a->id < b->id);
+}
+
+/* Return 0 if memory is exhausted.  */
+static int
+yy_repair_queue_push(yy_repair_queue *queue, yy_repairs *reps, yy_arena *arena)
+{
+  YYPTRDIFF_T i;
+
+  if (queue->length == queue->size)
+    {
+      YYPTRDIFF_T size = queue->size ? queue->size * 2 : 64;
+      yy_repairs **heap = (yy_repairs **) yy_arena_alloc (arena, YYSIZEOF (yy_repairs *) * size);
+      if (!heap)
+        return 0;
+      if (queue->length)
+        YYCOPY (heap, queue->heap, queue->length);
+      queue->heap = heap;
+      queue->size = size;
+    }
+
+  for (i = queue->length++; 0 < i; i = (i - 1) / 2)
+    {
+      yy_repairs *parent = queue->heap[(i - 1) / 2];
+      if (!yy_repairs_before (reps, parent))
+        break;
+      queue->heap[i] = parent;
+    }
+  queue->heap[i] = reps;
+  return 1;
+}
+
+static yy_repairs *
+yy_repair_queue_pop(yy_repair_queue *queue)
+{
+  yy_repairs *top;
+  yy_repairs *last;
+  YYPTRDIFF_T i = 0;
+
+  if (!queue->length)
+    return YY_NULLPTR;
+  top = queue->heap[0];
+  last = queue->heap[--queue->length];
+
+  for (;;)
+    {
+      YYPTRDIFF_T child = 2 * i + 1;
+      if (queue->length <= child)
+        break;
+      if (child + 1 < queue->length && yy_repairs_before (queue->heap[child + 1], queue->heap[child]))
+        child++;
+      if (!yy_repairs_before (queue->heap[child], last))
+        break;
+      queue->heap[i] = queue->heap[child];
+      i = child;
+    }
+  queue->heap[i] = last;
+  return top;
+}
+
+static YYSIZE_T
+yy_repairs_hash(YYPTRDIFF_T base, const yy_state_t *states, YYPTRDIFF_T length)
+{
+  YYSIZE_T hash = YY_CAST (YYSIZE_T, base) * 2654435761u;
+  YYPTRDIFF_T i;
+  for (i = 0; i < length; i++)
+    hash = (hash ^ states[i]) * 16777619u;
+  return hash;
+}
+
+static int
+yy_repair_states_equal(const yy_state_t *a, const yy_state_t *b, YYPTRDIFF_T length)
+{
+  YYPTRDIFF_T i;
+  for (i = 0; i < length; i++)
+    if (a[i] != b[i])
+      return 0;
+  return 1;
+}
+
+/* Return the slot of SET for the stack, which is null if the stack is
+   not in SET.  */
+static yy_repairs **
+yy_repair_set_find(yy_repair_set *set, YYSIZE_T hash, YYPTRDIFF_T base, const yy_state_t *states, YYPTRDIFF_T length)
 {
-  while (reps)
+  YYSIZE_T mask = YY_CAST (YYSIZE_T, set->size - 1);
+  YYSIZE_T i = hash & mask;
+
+  for (;; i = (i + 1) & mask)
     {
-      yy_repairs *r = reps;
-      reps = reps->next;
-      YYFREE (r->states);
-      YYFREE (r);
+      yy_repairs *r = set->slots[i];
+      if (!r
+          || (r->hash == hash && r->base == base && r->length == length
+              && yy_repair_states_equal (r->states, states, length)))
+        return &set->slots[i];
     }
 }
 
+/* Return 0 if memory is exhausted.  */
+static int
+yy_repair_set_reserve(yy_repair_set *set, yy_arena *arena)
+{
+  yy_repairs **slots;
+  YYPTRDIFF_T size;
+  YYPTRDIFF_T i;
+
+  if ((set->count + 1) * 2 <= set->size)
+    return 1;
+
+  slots = set->slots;
+  size = set->size;
+  set->size = size ? size * 2 : 64;
+  set->slots = (yy_repairs **) yy_arena_alloc (arena, YYSIZEOF (yy_repairs *) * set->size);
+  if (!set->slots)
+    return 0;
+  for (i = 0; i < set->size; i++)
+    set->slots[i] = YY_NULLPTR;
+  for (i = 0; i < size; i++)
+    if (slots[i])
+      *yy_repair_set_find (set, slots[i]->hash, slots[i]->base, slots[i]->states, slots[i]->length) = slots[i];
+  return 1;
+}
+
 static int
-yy_process_repairs(yy_repairs *reps, yysymbol_kind_t token)
+yy_process_repairs(yy_repair_stack *stack, yysymbol_kind_t token)
 {
   int yyn;
-  int yystate = *reps->state;
+  int yystate = yy_repair_stack_top (stack);
   int yylen = 0;
   yysymbol_kind_t yytoken = token;
 
   goto yyrecover_backup;
 
 yyrecover_newstate:
-  // TODO: check reps->stack_length
-  reps->state += 1;
-  *reps->state = (yy_state_t) yystate;
+  if (!yy_repair_stack_push (stack, (yy_state_t) yystate))
+    return 0;
 
 
 yyrecover_backup:
@@ -1314,10 +1816,16 @@ yyrecover_backup:
   if (yytoken == YYSYMBOL_YYEMPTY)
     return 1;
 
+<%- if output.dense_tables_defined? -%>
+  yyn = yydense_action[yystate * YYNTOKENS + yytoken];
+  if (yyn == 0)
+    goto yyrecover_default;
+<%- else -%>
   yyn += yytoken;
   if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
     goto yyrecover_default;
   yyn = yytable[yyn];
+<%- end -%>
   if (yyn <= 0)
     {
       if (yytable_value_is_error (yyn))
@@ -1342,15 +1850,20 @@ yyrecover_default:
 yyrecover_reduce:
   yylen = yyr2[yyn];
   /* YYPOPSTACK */
-  reps->state -= yylen;
+  yy_repair_stack_pop (stack, yylen);
   yylen = 0;
 
   {
     const int yylhs = yyr1[yyn] - YYNTOKENS;
-    const int yyi = yypgoto[yylhs] + *reps->state;
-    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *reps->state
+    const int yytop = yy_repair_stack_top (stack);
+<%- if output.dense_tables_defined? -%>
+    yystate = yydense_goto[yytop * YYNNTS + yylhs];
+<%- else -%>
+    const int yyi = yypgoto[yylhs] + yytop;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == yytop
                ? yytable[yyi]
                : yydefgoto[yylhs]);
+<%- end -%>
   }
 
   goto yyrecover_newstate;
@@ -1359,33 +1872,51 @@ yyrecover_errlab:
   return 0;
 }
 
+/* Search the shortest sequence of tokens to insert before the lookahead
+   by A* search, using YYREPAIR_DIST as the heuristic.  Candidates having
+   the same stack as an enqueued one are skipped, and the search gives up
+   after YYMAXREPAIRWORK candidates are processed.  The stack of a
+   candidate can not grow past YYMAXDEPTH, the size the parser's stack
+   can grow to.  */
 static yy_repair_terms *
-yyrecover(yy_state_t *yyss, yy_state_t *yyssp, int yychar<%= output.user_formals %>)
+yyrecover(yy_state_t *yyss, yy_state_t *yyssp, YYPTRDIFF_T yymaxdepth, int yychar<%= output.user_formals %>)
 {
   yysymbol_kind_t yytoken = YYTRANSLATE (yychar);
   yy_repair_terms *rep_terms = YY_NULLPTR;
   int count = 0;
-
-  yy_repairs *head = (yy_repairs *) YYMALLOC (sizeof (yy_repairs));
-  yy_repairs *current = head;
-  yy_repairs *tail = head;
-  YYPTRDIFF_T stack_length = yyssp - yyss + 1;
-
+  int work = 0;
+  YYPTRDIFF_T stack_size = yyssp - yyss + 1;
+  yy_arena arena = { YY_NULLPTR };
+  yy_repair_stack stack = { yyss, 0, YY_NULLPTR, 0, 0, yymaxdepth, &arena };
+  yy_repair_queue queue = { YY_NULLPTR, 0, 0 };
+  yy_repair_set set = { YY_NULLPTR, 0, 0 };
+  yy_repairs *current;
+
+  yy_repairs *head = (yy_repairs *) yy_arena_alloc (&arena, YYSIZEOF (yy_repairs));
+  if (!head)
+    goto done;
   head->id = count;
-  head->next = 0;
-  head->stack_length = stack_length;
-  head->states = (yy_state_t *) YYMALLOC (sizeof (yy_state_t) * (stack_length));
-  head->state = head->states + (yyssp - yyss);
-  YYCOPY (head->states, yyss, stack_length);
+  head->base = stack_size;
+  head->length = 0;
+  head->states = YY_NULLPTR;
+  head->hash = yy_repairs_hash (head->base, head->states, head->length);
+  head->state = *yyssp;
+  head->cost = YYREPAIR_DIST (head->state, yytoken);
   head->repair_length = 0;
   head->prev_repair = 0;
 
-  stack_length = (stack_length * 2 > 100) ? (stack_length * 2) : 100;
+  /* The lookahead follows the inserted tokens */
+  if (head->cost + 1 > YYMAXREPAIR(<%= output.parse_param_name %>))
+    goto done;
+  if (!yy_repair_set_reserve (&set, &arena) || !yy_repair_queue_push (&queue, head, &arena))
+    goto done;
+  *yy_repair_set_find (&set, head->hash, head->base, head->states, head->length) = head;
+  set.count++;
   count++;
 
-  while (current)
+  while ((current = yy_repair_queue_pop (&queue)))
     {
-      int yystate = *current->state;
+      int yystate = current->state;
       int yyn = yypact[yystate];
       /* See also: yypcontext_expected_tokens */
       if (!yypact_value_is_default (yyn))
@@ -1394,46 +1925,88 @@ yyrecover(yy_state_t *yyss, yy_state_t *yyssp, int yychar<%= output.user_formals
           int yychecklim = YYLAST - yyn + 1;
           int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
           int yyx;
+
+          /* Check whether the lookahead can be processed after the repairs */
+          if (yyxbegin <= yytoken && yytoken < yyxend && YYREPAIR_DIST (yystate, yytoken) == 0)
+            {
+              if (YYMAXREPAIRWORK(<%= output.parse_param_name %>) < ++work)
+                goto done;
+              if (! yy_repair_stack_load (&stack, current))
+                goto done;
+              if (yy_process_repairs (&stack, yytoken))
+                {
+                  rep_terms = yy_create_repair_terms (current<%= output.user_args %>);
+                  if (!rep_terms)
+                    goto done;
+                  YYDPRINTF ((stderr, "repair_terms found. id: %d, length: %d\n", rep_terms->id, rep_terms->length));
+                  yy_print_repairs (current<%= output.user_args %>);
+                  yy_print_repair_terms (rep_terms<%= output.user_args %>);
+
+                  goto done;
+                }
+            }
+
           for (yyx = yyxbegin; yyx < yyxend; ++yyx)
             {
-              if (yyx != YYSYMBOL_YYerror)
+              /* Tokens which are not shifted only after reductions fail */
+              if (yyx != YYSYMBOL_YYerror && YYREPAIR_DIST (yystate, yyx) == 0)
                 {
-                  if (current->repair_length + 1 > YYMAXREPAIR(<%= output.parse_param_name %>))
+                  int cost;
+                  YYPTRDIFF_T k = 0;
+                  yy_repairs **slot;
+
+                  if (current->repair_length + 2 > YYMAXREPAIR(<%= output.parse_param_name %>))
+                    continue;
+
+                  /* Process PDA assuming next token is yyx */
+                  if (YYMAXREPAIRWORK(<%= output.parse_param_name %>) < ++work)
+                    goto done;
+                  if (! yy_repair_stack_load (&stack, current))
+                    goto done;
+                  if (! yy_process_repairs (&stack, (yysymbol_kind_t)yyx))
+                    continue;
+
+                  cost = current->repair_length + 1 + YYREPAIR_DIST (yy_repair_stack_top (&stack), yytoken);
+                  if (cost + 1 > YYMAXREPAIR(<%= output.parse_param_name %>))
+                    continue;
+
+                  /* States pushed again over the same ones are shared */
+                  while (k < stack.length && stack.base + k < stack_size && stack.states[k] == yyss[stack.base + k])
+                    k++;
+                  stack.base += k;
+
+                  YYSIZE_T hash = yy_repairs_hash (stack.base, stack.states + k, stack.length - k);
+                  if (!yy_repair_set_reserve (&set, &arena))
+                    goto done;
+                  slot = yy_repair_set_find (&set, hash, stack.base, stack.states + k, stack.length - k);
+                  if (*slot && (*slot)->repair_length <= current->repair_length + 1)
                     continue;
 
-                  yy_repairs *reps = (yy_repairs *) YYMALLOC (sizeof (yy_repairs));
+                  /* Keep only the states pushed above the shared prefix */
+                  yy_repairs *reps = (yy_repairs *) yy_arena_alloc (&arena, YYSIZEOF (yy_repairs) + YYSIZEOF (yy_state_t) * (stack.length - k));
+                  if (!reps)
+                    goto done;
                   reps->id = count;
-                  reps->next = 0;
-                  reps->stack_length = stack_length;
-                  reps->states = (yy_state_t *) YYMALLOC (sizeof (yy_state_t) * (stack_length));
-                  reps->state = reps->states + (current->state - current->states);
-                  YYCOPY (reps->states, current->states, current->state - current->states + 1);
+                  reps->cost = cost;
+                  reps->hash = hash;
+                  reps->base = stack.base;
+                  reps->length = stack.length - k;
+                  reps->states = (yy_state_t *) (reps + 1);
+                  if (reps->length)
+                    YYCOPY (reps->states, stack.states + k, reps->length);
+                  reps->state = yy_repair_stack_top (&stack);
                   reps->repair_length = current->repair_length + 1;
                   reps->prev_repair = current;
                   reps->repair.type = inserting;
                   reps->repair.term = (yysymbol_kind_t) yyx;
 
-                  /* Process PDA assuming next token is yyx */
-                  if (! yy_process_repairs (reps, (yysymbol_kind_t)yyx))
-                    {
-                      YYFREE (reps);
-                      continue;
-                    }
-
-                  tail->next = reps;
-                  tail = reps;
+                  if (!*slot)
+                    set.count++;
+                  *slot = reps;
+                  if (!yy_repair_queue_push (&queue, reps, &arena))
+                    goto done;
                   count++;
 
-                  if (yyx == yytoken)
-                    {
-                      rep_terms = yy_create_repair_terms (current<%= output.user_args %>);
-                      YYDPRINTF ((stderr, "repair_terms found. id: %d, length: %d\n", rep_terms->id, rep_terms->length));
-                      yy_print_repairs (current<%= output.user_args %>);
-                      yy_print_repair_terms (rep_terms<%= output.user_args %>);
-
-                      goto done;
-                    }
-
                   YYDPRINTF ((stderr,
                         "New repairs is enqueued. count: %d, yystate: %d, yyx: %d\n",
                         count, yystate, yyx));
@@ -1441,13 +2014,11 @@ yyrecover(yy_state_t *yyss, yy_state_t *yyssp, int yychar<%= output.user_formals
                 }
             }
         }
-
-      current = current->next;
     }
 
 done:
 
-  yy_free_repairs(head<%= output.user_args %>);
+  yy_arena_free (&arena);
 
   if (!rep_terms)
     {
@@ -1460,6 +2031,340 @@ done:
 
 
 
+<%- if output.push_parser_defined? -%>
+/* Parser data structure.  */
+struct yypstate
+  {
+    /* Number of syntax errors so far.  */
+    int yynerrs;
+
+    yy_state_fast_t yystate;
+    /* Number of tokens to shift before error messages enabled.  */
+    int yyerrstatus;
+
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
+       to reallocate them elsewhere.  */
+
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize;
+    /* The size the stacks can grow to.  */
+    YYPTRDIFF_T yymaxdepth;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss;
+    yy_state_t *yyssp;
+
+    /* The semantic value stack: array, bottom, top.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs;
+    YYSTYPE *yyvsp;
+<%- if output.grammar.locations -%>
+
+    /* The location stack: array, bottom, top.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls;
+    YYLTYPE *yylsp;
+<%- end -%>
+
+    /* 1 until the first token has been pushed, 2 once the parse has
+       finished and the next push starts a new one, 0 otherwise.  */
+    int yynew;
+  };
+
+/* Reset the parser data structure to the start of a new parse.
+   A stack grown by a previous parse is kept for reuse.  */
+static void
+yypstate_clear (yypstate *yyps)
+{
+  yyps->yynerrs = 0;
+  yyps->yystate = 0;
+  yyps->yyerrstatus = 0;
+
+  yyps->yyssp = yyps->yyss;
+  yyps->yyvsp = yyps->yyvs;
+<%- if output.grammar.locations -%>
+  yyps->yylsp = yyps->yyls;
+<%- end -%>
+
+  *yyps->yyssp = 0;
+  yyps->yynew = 1;
+}
+
+/* Initialize the parser data structure whose stacks start with room
+   for YYINITDEPTH elements and can grow to YYMAXDEPTH elements.  A
+   nonpositive depth stands for the YYINITDEPTH or YYMAXDEPTH default.  */
+yypstate *
+yypstate_new_depth (long yyinitdepth, long yymaxdepth)
+{
+  yypstate *yyps;
+  yyps = YY_CAST (yypstate *, YYMALLOC (sizeof *yyps));
+  if (!yyps)
+    return YY_NULLPTR;
+  yyps->yymaxdepth = 0 < yymaxdepth ? yymaxdepth : YYMAXDEPTH;
+  yyps->yystacksize = 0 < yyinitdepth ? yyinitdepth : YYINITDEPTH;
+  if (yyps->yymaxdepth < yyps->yystacksize)
+    yyps->yystacksize = yyps->yymaxdepth;
+  yyps->yyss = yyps->yyssa;
+  yyps->yyvs = yyps->yyvsa;
+<%- if output.grammar.locations -%>
+  yyps->yyls = yyps->yylsa;
+<%- end -%>
+#if !defined yyoverflow && defined YYSTACK_RELOCATE
+  if (YYINITDEPTH < yyps->yystacksize)
+    {
+      YYPTRDIFF_T yysize = 0;
+      YYPTRDIFF_T yystacksize = yyps->yystacksize;
+      union yyalloc *yyptr =
+        YY_CAST (union yyalloc *,
+                 YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+      if (! yyptr)
+        {
+          YYFREE (yyps);
+          return YY_NULLPTR;
+        }
+      YYSTACK_RELOCATE (yyss_alloc, yyps->yyss);
+      YYSTACK_RELOCATE (yyvs_alloc, yyps->yyvs);
+<%- if output.grammar.locations -%>
+      YYSTACK_RELOCATE (yyls_alloc, yyps->yyls);
+<%- end -%>
+    }
+#else
+  if (YYINITDEPTH < yyps->yystacksize)
+    yyps->yystacksize = YYINITDEPTH;
+#endif
+  yypstate_clear (yyps);
+  return yyps;
+}
+
+/* Initialize the parser data structure.  */
+yypstate *
+yypstate_new (void)
+{
+  return yypstate_new_depth (0, 0);
+}
+
+void
+yypstate_delete (yypstate *yyps)
+{
+  if (yyps)
+    {
+#ifndef yyoverflow
+      /* If the stack was reallocated, it still needs to be freed.  */
+      if (yyps->yyss != yyps->yyssa)
+        YYSTACK_FREE (yyps->yyss);
+#endif
+      YYFREE (yyps);
+    }
+}
+
+<%- if output.pull_parser_defined? -%>
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (<%= output.parse_param %>)
+{
+  yypstate *yyps = yypstate_new ();
+  if (!yyps)
+    {
+      static const YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+<%- if output.compact_location_defined? -%>
+        = { 0, 0 }
+<%- else -%>
+        = { 1, 1, 1, 1 }
+<%- end -%>
+# endif
+      ;
+      YYLTYPE yylloc = yyloc_default;
+      yyerror (<%= output.yyerror_args %>, YY_("memory exhausted"));
+      return 2;
+    }
+  int yystatus = yypull_parse (yyps<%= output.user_args %>);
+  yypstate_delete (yyps);
+  return yystatus;
+}
+
+
+/*---------------.
+| yypull_parse.  |
+`---------------*/
+
+int
+yypull_parse (yypstate *yyps<%= output.user_formals %>)
+{
+  YY_ASSERT (yyps);
+  int yystatus;
+  do {
+    YYSTYPE yylval;
+<%- if output.grammar.locations -%>
+    static const YYLTYPE yyloc_default
+# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+<%- if output.compact_location_defined? -%>
+      = { 0, 0 }
+<%- else -%>
+      = { 1, 1, 1, 1 }
+<%- end -%>
+# endif
+    ;
+    YYLTYPE yylloc = yyloc_default;
+    int yychar = yylex <%= output.yylex_formals %>;
+    yystatus = yypush_parse (yyps, yychar, &yylval, &yylloc<%= output.user_args %>);
+<%- else -%>
+    int yychar = yylex <%= output.yylex_formals %>;
+    yystatus = yypush_parse (yyps, yychar, &yylval, YY_NULLPTR<%= output.user_args %>);
+<%- end -%>
+  } while (yystatus == YYPUSH_MORE);
+  return yystatus;
+}
+
+<%- end -%>
+#define yynerrs yyps->yynerrs
+#define yystate yyps->yystate
+#define yyerrstatus yyps->yyerrstatus
+#define yystacksize yyps->yystacksize
+#define yyssa yyps->yyssa
+#define yyss yyps->yyss
+#define yyssp yyps->yyssp
+#define yyvsa yyps->yyvsa
+#define yyvs yyps->yyvs
+#define yyvsp yyps->yyvsp
+<%- if output.grammar.locations -%>
+#define yylsa yyps->yylsa
+#define yyls yyps->yyls
+#define yylsp yyps->yylsp
+<%- end -%>
+
+/*---------------.
+| yypush_parse.  |
+`---------------*/
+
+int
+yypush_parse (yypstate *yyps,
+              int yypushed_char, YYSTYPE const *yypushed_val, YYLTYPE *yypushed_loc<%= output.user_formals %>)
+{
+<%- elsif output.parser_context_defined? -%>
+/* Stacks kept by the caller across parses.  */
+struct yyparse_context
+  {
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize;
+    /* The size the stacks can grow to.  */
+    YYPTRDIFF_T yymaxdepth;
+
+    /* The state stack: array, bottom.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss;
+
+    /* The semantic value stack: array, bottom.  */
+    YYSTYPE yyvsa[YYINITDEPTH];
+    YYSTYPE *yyvs;
+<%- if output.grammar.locations -%>
+
+    /* The location stack: array, bottom.  */
+    YYLTYPE yylsa[YYINITDEPTH];
+    YYLTYPE *yyls;
+<%- end -%>
+  };
+
+/* Initialize stacks with room for YYINITDEPTH elements that can grow to
+   YYMAXDEPTH elements.  A nonpositive depth stands for the YYINITDEPTH or
+   YYMAXDEPTH default.  Return nonzero if memory is exhausted.  */
+static int
+yyparse_context_init (yyparse_context *yyctx, long yyinitdepth, long yymaxdepth)
+{
+  yyctx->yymaxdepth = 0 < yymaxdepth ? yymaxdepth : YYMAXDEPTH;
+  yyctx->yystacksize = 0 < yyinitdepth ? yyinitdepth : YYINITDEPTH;
+  if (yyctx->yymaxdepth < yyctx->yystacksize)
+    yyctx->yystacksize = yyctx->yymaxdepth;
+  yyctx->yyss = yyctx->yyssa;
+  yyctx->yyvs = yyctx->yyvsa;
+<%- if output.grammar.locations -%>
+  yyctx->yyls = yyctx->yylsa;
+<%- end -%>
+#if !defined yyoverflow && defined YYSTACK_RELOCATE
+  if (YYINITDEPTH < yyctx->yystacksize)
+    {
+      YYPTRDIFF_T yysize = 0;
+      YYPTRDIFF_T yystacksize = yyctx->yystacksize;
+      union yyalloc *yyptr =
+        YY_CAST (union yyalloc *,
+                 YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
+      if (! yyptr)
+        return 1;
+      YYSTACK_RELOCATE (yyss_alloc, yyctx->yyss);
+      YYSTACK_RELOCATE (yyvs_alloc, yyctx->yyvs);
+<%- if output.grammar.locations -%>
+      YYSTACK_RELOCATE (yyls_alloc, yyctx->yyls);
+<%- end -%>
+    }
+#else
+  if (YYINITDEPTH < yyctx->yystacksize)
+    yyctx->yystacksize = YYINITDEPTH;
+#endif
+  return 0;
+}
+
+static void
+yyparse_context_free (yyparse_context *yyctx)
+{
+#ifndef yyoverflow
+  if (yyctx->yyss != yyctx->yyssa)
+    YYSTACK_FREE (yyctx->yyss);
+#endif
+}
+
+yyparse_context *
+yyparse_context_new (long initdepth, long maxdepth)
+{
+  yyparse_context *yyctx;
+  yyctx = YY_CAST (yyparse_context *, YYMALLOC (sizeof *yyctx));
+  if (!yyctx)
+    return YY_NULLPTR;
+  if (yyparse_context_init (yyctx, initdepth, maxdepth))
+    {
+      YYFREE (yyctx);
+      return YY_NULLPTR;
+    }
+  return yyctx;
+}
+
+void
+yyparse_context_delete (yyparse_context *yyctx)
+{
+  if (yyctx)
+    {
+      yyparse_context_free (yyctx);
+      YYFREE (yyctx);
+    }
+}
+
+/*----------.
+| yyparse.  |
+`----------*/
+
+int
+yyparse (<%= output.parse_param %>)
+{
+  yyparse_context yyctx;
+  int yyresult;
+  yyparse_context_init (&yyctx, 0, 0);
+  yyresult = yyparse_context_parse (&yyctx<%= output.user_args %>);
+  yyparse_context_free (&yyctx);
+  return yyresult;
+}
+
+
+/*------------------------.
+| yyparse_context_parse.  |
+`------------------------*/
+
+int
+yyparse_context_parse (yyparse_context *yyctx<%= output.user_formals %>)
+{
+<%- else -%>
 /*----------.
 | yyparse.  |
 `----------*/
@@ -1467,6 +2372,7 @@ done:
 int
 yyparse (<%= output.parse_param %>)
 {
+<%- end -%>
 <%# b4_declare_scanner_communication_variables -%>
 /* Lookahead token kind.  */
 int yychar;
@@ -1486,12 +2392,17 @@ YYSTYPE yylval YY_INITIAL_VALUE (= yyval_default);
 /* Location data for the lookahead symbol.  */
 static const YYLTYPE yyloc_default
 # if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+<%- if output.compact_location_defined? -%>
+  = { 0, 0 }
+<%- else -%>
   = { 1, 1, 1, 1 }
+<%- end -%>
 # endif
 ;
 YYLTYPE yylloc = yyloc_default;
 
 <%# b4_declare_parser_state_variables -%>
+<%- unless output.push_parser_defined? -%>
     /* Number of syntax errors so far.  */
     int yynerrs = 0;
     YY_USE (yynerrs); /* Silence compiler warning.  */
@@ -1503,6 +2414,26 @@ YYLTYPE yylloc = yyloc_default;
     /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
+<%- if output.parser_context_defined? -%>
+    /* Their size and the size they can grow to.  */
+    YYPTRDIFF_T yystacksize = yyctx->yystacksize;
+    YYPTRDIFF_T yymaxdepth = yyctx->yymaxdepth;
+
+    /* The state stack: array, bottom, top.  */
+    yy_state_t *yyssa = yyctx->yyssa;
+    yy_state_t *yyss = yyctx->yyss;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: bottom, top.  */
+    YYSTYPE *yyvs = yyctx->yyvs;
+    YYSTYPE *yyvsp = yyvs;
+<%- if output.grammar.locations -%>
+
+    /* The location stack: bottom, top.  */
+    YYLTYPE *yyls = yyctx->yyls;
+    YYLTYPE *yylsp = yyls;
+<%- end -%>
+<%- else -%>
     /* Their size.  */
     YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
@@ -1515,12 +2446,16 @@ YYLTYPE yylloc = yyloc_default;
     YYSTYPE yyvsa[YYINITDEPTH];
     YYSTYPE *yyvs = yyvsa;
     YYSTYPE *yyvsp = yyvs;
+<%- if output.grammar.locations -%>
 
     /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
     YYLTYPE *yyls = yylsa;
     YYLTYPE *yylsp = yyls;
+<%- end -%>
+<%- end -%>
 
+<%- end -%>
   int yyn;
   /* The return value of yyparse.  */
   int yyresult;
@@ -1529,10 +2464,12 @@ YYLTYPE yylloc = yyloc_default;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
+<%- if output.grammar.locations -%>
   YYLTYPE yyloc;
 
   /* The locations where the error started and ended.  */
   YYLTYPE yyerror_range[3];
+<%- end -%>
 <%- if output.error_recovery -%>
   yy_repair_terms *rep_terms = 0;
   yy_term term_backup;
@@ -1545,12 +2482,32 @@ YYLTYPE yylloc = yyloc_default;
   char *yymsg = yymsgbuf;
   YYPTRDIFF_T yymsg_alloc = sizeof yymsgbuf;
 
+<%- if output.grammar.locations -%>
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
+<%- else -%>
+#define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N))
+<%- end -%>
 
   /* The number of symbols on the RHS of the reduced rule.
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
+<%- if output.push_parser_defined? -%>
+  switch (yyps->yynew)
+    {
+    case 0:
+      yyn = yypact[yystate];
+      goto yyread_pushed_token;
+
+    case 2:
+      yypstate_clear (yyps);
+      break;
+
+    default:
+      break;
+    }
+
+<%- end -%>
   YYDPRINTF ((stderr, "Starting parse\n"));
 
   yychar = YYEMPTY; /* Cause a token to be read.  */
@@ -1560,7 +2517,12 @@ YYLTYPE yylloc = yyloc_default;
 <%= output.user_initial_action("/* User initialization code.  */") %>
 #line [@oline@] [@ofile@]
 
+<%- if !output.grammar.locations -%>
+<%- elsif output.push_parser_defined? -%>
+  yylsp[0] = yypushed_loc ? *yypushed_loc : yylloc;
+<%- else -%>
   yylsp[0] = yylloc;
+<%- end -%>
   goto yysetstate;
 
 
@@ -1599,7 +2561,9 @@ yysetstate:
            memory.  */
         yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
+<%- if output.grammar.locations -%>
         YYLTYPE *yyls1 = yyls;
+<%- end -%>
 
         /* Each stack pointer address is followed by the size of the
            data in use in that stack, in bytes.  This used to be a
@@ -1608,19 +2572,37 @@ yysetstate:
         yyoverflow (YY_("memory exhausted"),
                     &yyss1, yysize * YYSIZEOF (*yyssp),
                     &yyvs1, yysize * YYSIZEOF (*yyvsp),
+<%- if output.grammar.locations -%>
                     &yyls1, yysize * YYSIZEOF (*yylsp),
+<%- end -%>
                     &yystacksize);
         yyss = yyss1;
         yyvs = yyvs1;
+<%- if output.grammar.locations -%>
         yyls = yyls1;
+<%- end -%>
       }
 # else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
+<%- if output.push_parser_defined? -%>
+      if (yyps->yymaxdepth <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (yyps->yymaxdepth < yystacksize)
+        yystacksize = yyps->yymaxdepth;
+<%- elsif output.parser_context_defined? -%>
+      if (yymaxdepth <= yystacksize)
+        YYNOMEM;
+      yystacksize *= 2;
+      if (yymaxdepth < yystacksize)
+        yystacksize = yymaxdepth;
+<%- else -%>
       if (YYMAXDEPTH <= yystacksize)
         YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
+<%- end -%>
 
       {
         yy_state_t *yyss1 = yyss;
@@ -1631,7 +2613,9 @@ yysetstate:
           YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
+<%- if output.grammar.locations -%>
         YYSTACK_RELOCATE (yyls_alloc, yyls);
+<%- end -%>
 #  undef YYSTACK_RELOCATE
         if (yyss1 != yyssa)
           YYSTACK_FREE (yyss1);
@@ -1640,7 +2624,9 @@ yysetstate:
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
+<%- if output.grammar.locations -%>
       yylsp = yyls + yysize - 1;
+<%- end -%>
 
       YY_IGNORE_USELESS_CAST_BEGIN
       YYDPRINTF ((stderr, "Stack size increased to %ld\n",
@@ -1663,6 +2649,21 @@ yysetstate:
 | yybackup.  |
 `-----------*/
 yybackup:
+<%- if output.direct_parser? -%>
+  /* Jump to the code of the current state.  */
+  switch (yystate)
+    {
+<%= output.direct_state_dispatch -%>
+      default: YYABORT;
+    }
+
+<%= output.direct_states -%>
+
+/*-------------------------------------------------------------.
+| yyread -- read a lookahead token then back to current state. |
+`-------------------------------------------------------------*/
+yyread:
+<%- else -%>
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1673,6 +2674,7 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
+<%- end -%>
 <%- if output.error_recovery -%>
   if (YYERROR_RECOVERY_ENABLED(<%= output.parse_param_name %>))
     {
@@ -1709,8 +2711,25 @@ yybackup:
   /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
+<%- if output.push_parser_defined? -%>
+      if (!yyps->yynew)
+        {
+          YYDPRINTF ((stderr, "Return for a new token:\n"));
+          yyresult = YYPUSH_MORE;
+          goto yypushreturn;
+        }
+      yyps->yynew = 0;
+yyread_pushed_token:
+      YYDPRINTF ((stderr, "Reading a token\n"));
+      yychar = yypushed_char;
+      if (yypushed_val)
+        yylval = *yypushed_val;
+      if (yypushed_loc)
+        yylloc = *yypushed_loc;
+<%- else -%>
       YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex <%= output.yylex_formals %>;
+<%- end -%>
     }
 
   if (yychar <= <%= output.eof_symbol.id.s_value %>)
@@ -1727,7 +2746,9 @@ yybackup:
          loop in error recovery. */
       yychar = <%= output.undef_symbol.id.s_value %>;
       yytoken = <%= output.error_symbol.enum_name %>;
+<%- if output.grammar.locations -%>
       yyerror_range[1] = yylloc;
+<%- end -%>
       goto yyerrlab1;
     }
   else
@@ -1736,12 +2757,21 @@ yybackup:
       YY_SYMBOL_PRINT ("Next token is", yytoken, &yylval, &yylloc<%= output.user_args %>);
     }
 
+<%- if output.direct_parser? -%>
+  goto yybackup;
+<%- else -%>
   /* If the proper action on seeing token YYTOKEN is to reduce or to
      detect an error, take that action.  */
+<%- if output.dense_tables_defined? -%>
+  yyn = yydense_action[yystate * YYNTOKENS + yytoken];
+  if (yyn == 0)
+    goto yydefault;
+<%- else -%>
   yyn += yytoken;
   if (yyn < 0 || YYLAST < yyn || yycheck[yyn] != yytoken)
     goto yydefault;
   yyn = yytable[yyn];
+<%- end -%>
   if (yyn <= 0)
     {
       if (yytable_value_is_error (yyn))
@@ -1761,7 +2791,9 @@ yybackup:
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
+<%- if output.grammar.locations -%>
   *++yylsp = yylloc;
+<%- end -%>
 <%= output.after_shift_function("/* %after-shift code. */") %>
 
   /* Discard the shifted token.  */
@@ -1777,6 +2809,7 @@ yydefault:
   if (yyn == 0)
     goto yyerrlab;
   goto yyreduce;
+<%- end -%>
 
 
 /*-----------------------------.
@@ -1797,9 +2830,11 @@ yyreduce:
   yyval = yyvsp[1-yylen];
 <%= output.before_reduce_function("/* %before-reduce function. */") %>
 
-  /* Default location. */
-  YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
-  yyerror_range[1] = yyloc;
+<%- if output.grammar.locations -%>
+  /* Default location, for the actions which refer to a location.  */
+  if (yyrloc[yyn])
+    YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+<%- end -%>
   YY_REDUCE_PRINT (yyn<%= output.user_args %>);
   switch (yyn)
     {
@@ -1818,24 +2853,49 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
+<%- if output.grammar.locations -%>
+#if YYDEBUG
+  if (yydebug && !yyrloc[yyn])
+    YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+#endif
   YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc<%= output.user_args %>);
+<%- else -%>
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, YY_NULLPTR<%= output.user_args %>);
+<%- end -%>
 
   YYPOPSTACK (yylen);
 <%= output.after_reduce_function("/* %after-reduce function. */") %>
+<%- if output.grammar.locations -%>
+  if (yyrloc[yyn])
+    yylsp[1] = yyloc;
+  else
+    YYLLOC_DEFAULT_TOP (yylsp, yylen);
+  ++yylsp;
+<%- end -%>
   yylen = 0;
 
   *++yyvsp = yyval;
-  *++yylsp = yyloc;
 
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
+<%- if output.direct_parser? -%>
+  switch (yyr1[yyn])
+    {
+<%= output.direct_gotos -%>
+      default: break;
+    }
+<%- end -%>
   {
     const int yylhs = yyr1[yyn] - YYNTOKENS;
+<%- if output.dense_tables_defined? -%>
+    yystate = yydense_goto[*yyssp * YYNNTS + yylhs];
+<%- else -%>
     const int yyi = yypgoto[yylhs] + *yyssp;
     yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
                ? yytable[yyi]
                : yydefgoto[yylhs]);
+<%- end -%>
   }
 
   goto yynewstate;
@@ -1885,7 +2945,9 @@ yyerrlab:
       }
     }
 
+<%- if output.grammar.locations -%>
   yyerror_range[1] = yylloc;
+<%- end -%>
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -1919,6 +2981,9 @@ yyerrorlab:
   if (0)
     YYERROR;
   ++yynerrs;
+<%- if output.grammar.locations -%>
+  YYLLOC_DEFAULT (yyerror_range[1], (yylsp - yylen), yylen);
+<%- end -%>
 
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
@@ -1937,7 +3002,15 @@ yyerrlab1:
 <%- if output.error_recovery -%>
   if (YYERROR_RECOVERY_ENABLED(<%= output.parse_param_name %>))
     {
-      rep_terms = yyrecover (yyss, yyssp, yychar<%= output.user_args %>);
+      if (rep_terms)
+        YYFREE (rep_terms);
+<%- if output.push_parser_defined? -%>
+      rep_terms = yyrecover (yyss, yyssp, yyps->yymaxdepth, yychar<%= output.user_args %>);
+<%- elsif output.parser_context_defined? -%>
+      rep_terms = yyrecover (yyss, yyssp, yymaxdepth, yychar<%= output.user_args %>);
+<%- else -%>
+      rep_terms = yyrecover (yyss, yyssp, YYMAXDEPTH, yychar<%= output.user_args %>);
+<%- end -%>
       if (rep_terms)
         {
           for (int i = 0; i < rep_terms->length; i++)
@@ -1966,6 +3039,11 @@ yyerrlab1:
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
+<%- if output.dense_tables_defined? -%>
+          yyn = yydense_action[yystate * YYNTOKENS + YYSYMBOL_YYerror];
+          if (0 < yyn)
+            break;
+<%- else -%>
           yyn += YYSYMBOL_YYerror;
           if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
@@ -1973,15 +3051,21 @@ yyerrlab1:
               if (0 < yyn)
                 break;
             }
+<%- end -%>
         }
 
       /* Pop the current state because it cannot handle the error token.  */
       if (yyssp == yyss)
         YYABORT;
 
+<%- if output.grammar.locations -%>
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
                   YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp<%= output.user_args %>);
+<%- else -%>
+      yydestruct ("Error: popping",
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, YY_NULLPTR<%= output.user_args %>);
+<%- end -%>
       YYPOPSTACK (1);
 <%= output.after_pop_stack_function(1, "/* %after-pop-stack function. */") %>
       yystate = *yyssp;
@@ -1992,12 +3076,17 @@ yyerrlab1:
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
+<%- if output.grammar.locations -%>
   yyerror_range[2] = yylloc;
   ++yylsp;
   YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
   YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp<%= output.user_args %>);
+<%- else -%>
+  /* Shift the error token.  */
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, YY_NULLPTR<%= output.user_args %>);
+<%- end -%>
 <%= output.after_shift_error_token_function("/* %after-shift-error-token code. */") %>
 
   yystate = yyn;
@@ -2047,18 +3136,63 @@ yyreturnlab:
   YY_STACK_PRINT (yyss, yyssp<%= output.user_args %>);
   while (yyssp != yyss)
     {
+<%- if output.grammar.locations -%>
       yydestruct ("Cleanup: popping",
                   YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp<%= output.user_args %>);
+<%- else -%>
+      yydestruct ("Cleanup: popping",
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, YY_NULLPTR<%= output.user_args %>);
+<%- end -%>
       YYPOPSTACK (1);
     }
+<%- if output.error_recovery -%>
+  if (rep_terms)
+    YYFREE (rep_terms);
+<%- end -%>
+<%- if output.push_parser_defined? -%>
+  /* The stacks are kept for the next parse and freed by yypstate_delete.  */
+  yyps->yynew = 2;
+
+/*-------------------------------------------------------.
+| yypushreturn -- return to the caller of yypush_parse.  |
+`-------------------------------------------------------*/
+yypushreturn:
+<%- elsif output.parser_context_defined? -%>
+  /* The stacks are kept in the context for the next parse.  */
+  yyctx->yystacksize = yystacksize;
+  yyctx->yyss = yyss;
+  yyctx->yyvs = yyvs;
+<%- if output.grammar.locations -%>
+  yyctx->yyls = yyls;
+<%- end -%>
+<%- else -%>
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
+<%- end -%>
   if (yymsg != yymsgbuf)
     YYSTACK_FREE (yymsg);
   return yyresult;
 }
+<%- if output.push_parser_defined? -%>
+
+#undef yynerrs
+#undef yystate
+#undef yyerrstatus
+#undef yystacksize
+#undef yyssa
+#undef yyss
+#undef yyssp
+#undef yyvsa
+#undef yyvs
+#undef yyvsp
+<%- if output.grammar.locations -%>
+#undef yylsa
+#undef yyls
+#undef yylsp
+<%- end -%>
+<%- end -%>
 
 <%# b4_percent_code_get([[epilogue]]) -%>
 <%- if output.aux.epilogue -%>